@@ -0,0 +1,317 @@
+#include "Generator.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#define chdir _chdir
+#else
+#include <unistd.h>
+#endif
+
+// Runs the whole compiler over generated programs that double in size at each
+// step, and reports how long each phase took. A phase that's linear in the
+// scaled parameter roughly doubles each step, one that's quadratic quadruples,
+// so the growth column shows which phases don't scale
+//
+//   bench [options] nav workDir
+//
+// The programs are written to workDir/src, the compiler's output goes to
+// workDir/output, every report is kept in workDir/results.csv. Build it from
+// Bench.c and Generator.c, linking the maths library
+
+#define MAX_PHASES 16
+#define MAX_STEPS 16
+#define PATH_SIZE 1024
+
+typedef struct PhaseResult {
+  char name[64];
+  double wall[MAX_STEPS]; // Fastest run at each step, in milliseconds
+} PhaseResult;
+
+typedef struct Bench {
+  char nav[PATH_SIZE];
+  GenConfig cfg;
+  int *scaled; // The config value doubled each step
+  char *scaledName;
+  int steps;
+  int runs;
+  int jobs;
+
+  PhaseResult phases[MAX_PHASES];
+  int phaseCount;
+  int values[MAX_STEPS];
+} Bench;
+
+typedef struct ScaleOption {
+  char *name;
+  int offset;
+} ScaleOption;
+
+const ScaleOption scaleOptions[] = {
+    {"files", offsetof(GenConfig, files)},
+    {"funcs", offsetof(GenConfig, funcs)},
+    {"structs", offsetof(GenConfig, structs)},
+    {"enums", offsetof(GenConfig, enums)},
+    {"members", offsetof(GenConfig, enumMembers)},
+    {"depth", offsetof(GenConfig, depth)},
+    {"expr", offsetof(GenConfig, exprLen)},
+};
+
+#define SCALE_OPTION_COUNT (int)(sizeof(scaleOptions) / sizeof(ScaleOption))
+
+void printUsage(void) {
+  printf("Usage: bench [options] nav workDir\n");
+  printf("  --scale NAME  What to double each step, one of files, funcs, "
+         "structs,\n                enums, members, depth or expr (default "
+         "funcs)\n");
+  printf("  --steps N     Number of steps (default 5, at most %i)\n",
+         MAX_STEPS);
+  printf("  --runs N      Runs at each step, the fastest is kept (default "
+         "3)\n");
+  printf("  -j N          Threads for the compiler's front end (default 1)\n");
+  printGenOptions();
+}
+
+errno_t fullPath(char *dest, char *path) {
+#ifdef _WIN32
+  return _fullpath(dest, path, PATH_SIZE) == NULL;
+#else
+  return realpath(path, dest) == NULL;
+#endif
+}
+
+PhaseResult *findPhase(Bench *b, char *name) {
+  for (int i = 0; i < b->phaseCount; ++i) {
+    if (!strcmp(b->phases[i].name, name)) {
+      return b->phases + i;
+    }
+  }
+
+  if (b->phaseCount == MAX_PHASES) {
+    return NULL;
+  }
+
+  PhaseResult *phase = b->phases + b->phaseCount;
+  ++b->phaseCount;
+
+  snprintf(phase->name, sizeof(phase->name), "%s", name);
+  for (int i = 0; i < MAX_STEPS; ++i) {
+    phase->wall[i] = -1;
+  }
+
+  return phase;
+}
+
+// Reads the whole program phases out of a --time-report=json report, per file
+// phases are skipped since they're already summed up in their own phase
+errno_t readReport(Bench *b, int step, FILE *csv) {
+  FILE *f;
+  if (fopen_s(&f, "report.json", "r")) {
+    return 1;
+  }
+
+  char line[1024];
+  while (fgets(line, sizeof(line), f) != NULL) {
+    char *name = strstr(line, "{\"phase\": \"");
+    char *wall = strstr(line, "\"wallMs\": ");
+    if (name == NULL || wall == NULL || !strstr(line, "\"file\": null")) {
+      continue;
+    }
+
+    name += strlen("{\"phase\": \"");
+    *strchr(name, '"') = 0;
+
+    double ms = strtod(wall + strlen("\"wallMs\": "), NULL);
+    fprintf(csv, "%s,%i,%s,%.3f\n", b->scaledName, b->values[step], name, ms);
+
+    PhaseResult *phase = findPhase(b, name);
+    if (phase != NULL && (phase->wall[step] < 0 || ms < phase->wall[step])) {
+      phase->wall[step] = ms;
+    }
+  }
+
+  fclose(f);
+  return 0;
+}
+
+// Generates the program for one step and compiles it runs times
+errno_t runStep(Bench *b, int step, FILE *csv) {
+  b->values[step] = *b->scaled;
+
+  if (generateProgram(&b->cfg, "src")) {
+    printf("Couldn't generate the program\n");
+    return 1;
+  }
+
+  // The compiler writes to ../output/main.c, so it's run from inside src
+  char command[PATH_SIZE * 2];
+  int len = snprintf(command, sizeof(command),
+                     "cd src && \"%s\" -j %i --time-report=json", b->nav,
+                     b->jobs);
+  for (int i = 0; i < b->cfg.files && len < (int)sizeof(command); ++i) {
+    len += snprintf(command + len, sizeof(command) - len, " gen%04i.nav", i);
+  }
+  if (len < (int)sizeof(command)) {
+    len += snprintf(command + len, sizeof(command) - len,
+                    " > ../compile.log 2> ../report.json");
+  }
+  if (len >= (int)sizeof(command)) {
+    printf("Too many files to fit in the command line\n");
+    return 1;
+  }
+
+  for (int run = 0; run < b->runs; ++run) {
+    if (system(command)) {
+      printf("Compiling step %i failed, see compile.log\n", step);
+      return 1;
+    }
+
+    if (readReport(b, step, csv)) {
+      printf("Couldn't read the time report\n");
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+void printResults(Bench *b) {
+  printf("\n%-20s", b->scaledName);
+  for (int s = 0; s < b->steps; ++s) {
+    printf(" %10i", b->values[s]);
+  }
+  printf(" %8s\n", "Growth");
+
+  for (int i = 0; i < b->phaseCount; ++i) {
+    PhaseResult *phase = b->phases + i;
+
+    printf("%-20s", phase->name);
+    for (int s = 0; s < b->steps; ++s) {
+      printf(" %10.3f", phase->wall[s]);
+    }
+
+    // The power of the scaled value the phase's time grew with over the last
+    // step, too small a time is mostly noise
+    if (b->steps < 2 || phase->wall[b->steps - 2] < 0.05) {
+      printf(" %8s\n", "-");
+      continue;
+    }
+
+    double first = phase->wall[b->steps - 2];
+    double last = phase->wall[b->steps - 1];
+    double growth = log(last / first) /
+                    log((double)b->values[b->steps - 1] /
+                        b->values[b->steps - 2]);
+    printf(" %8.2f%s\n", growth, growth > 1.5 ? "  superlinear" : "");
+  }
+}
+
+int main(int argc, char *argv[]) {
+  Bench b = {0};
+  b.cfg = DEFAULT_GEN_CONFIG;
+  b.scaledName = "funcs";
+  b.steps = 5;
+  b.runs = 3;
+  b.jobs = 1;
+
+  char *args[2];
+  int argCount = 0;
+
+  for (int i = 1; i < argc; ++i) {
+    int used = readGenOption(&b.cfg, argc, argv, i);
+    if (used) {
+      i += used - 1;
+      continue;
+    }
+
+    if (i + 1 < argc && !strcmp(argv[i], "--scale")) {
+      b.scaledName = argv[++i];
+      continue;
+    }
+
+    if (i + 1 < argc && !strcmp(argv[i], "--steps")) {
+      b.steps = atoi(argv[++i]);
+      continue;
+    }
+
+    if (i + 1 < argc && !strcmp(argv[i], "--runs")) {
+      b.runs = atoi(argv[++i]);
+      continue;
+    }
+
+    if (i + 1 < argc && !strcmp(argv[i], "-j")) {
+      b.jobs = atoi(argv[++i]);
+      continue;
+    }
+
+    if (argv[i][0] == '-' || argCount == 2) {
+      printUsage();
+      return 1;
+    }
+
+    args[argCount] = argv[i];
+    ++argCount;
+  }
+
+  if (argCount != 2 || b.steps < 1 || b.steps > MAX_STEPS || b.runs < 1 ||
+      b.jobs < 1) {
+    printUsage();
+    return 1;
+  }
+
+  for (int i = 0; i < SCALE_OPTION_COUNT; ++i) {
+    if (!strcmp(b.scaledName, scaleOptions[i].name)) {
+      b.scaled = (int *)((char *)&b.cfg + scaleOptions[i].offset);
+    }
+  }
+  if (b.scaled == NULL) {
+    printUsage();
+    return 1;
+  }
+  if (*b.scaled < 1) {
+    printf("--%s has to be at least 1 to be doubled\n", b.scaledName);
+    return 1;
+  }
+
+  // The work directory becomes the current one, so the compiler has to be
+  // found first
+  if (fullPath(b.nav, args[0])) {
+    printf("Couldn't find the compiler at %s\n", args[0]);
+    return 1;
+  }
+
+  if (makeDir(args[1]) || chdir(args[1]) || makeDir("src") ||
+      makeDir("output")) {
+    printf("Couldn't set up the work directory %s\n", args[1]);
+    return 1;
+  }
+
+  FILE *csv;
+  if (fopen_s(&csv, "results.csv", "w")) {
+    printf("Couldn't open results.csv\n");
+    return 1;
+  }
+  fprintf(csv, "parameter,value,phase,wallMs\n");
+
+  for (int s = 0; s < b.steps; ++s) {
+    printf("Step %i: %s = %i\n", s + 1, b.scaledName, *b.scaled);
+
+    if (runStep(&b, s, csv)) {
+      fclose(csv);
+      return 1;
+    }
+
+    *b.scaled *= 2;
+  }
+
+  fclose(csv);
+
+  printResults(&b);
+
+  return 0;
+}
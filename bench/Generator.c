@@ -0,0 +1,281 @@
+#include "Generator.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <errno.h>
+#else
+#include <errno.h>
+#include <sys/stat.h>
+#endif
+
+typedef struct Gen {
+  GenConfig *cfg;
+  FILE *out;
+  int file; // The file being generated
+  int func; // The function being generated
+  unsigned int rand;
+} Gen;
+
+// xorshift, good enough to vary the programs and the same everywhere
+unsigned int nextRand(Gen *g) {
+  g->rand ^= g->rand << 13;
+  g->rand ^= g->rand >> 17;
+  g->rand ^= g->rand << 5;
+  return g->rand;
+}
+
+int randBelow(Gen *g, int n) { return nextRand(g) % n; }
+
+void indent(Gen *g, int level) {
+  for (int i = 0; i < level; ++i) {
+    fputc('\t', g->out);
+  }
+}
+
+// One operand of an expression. vars is how many of v0, v1... are in scope,
+// loops is how many of i1, i2... are
+void genOperand(Gen *g, int vars, int loops) {
+  switch (randBelow(g, 6)) {
+  case 0:
+    fprintf(g->out, "%i", randBelow(g, 100));
+    break;
+  case 1:
+    fprintf(g->out, "%c", randBelow(g, 2) ? 'a' : 'b');
+    break;
+  case 2:
+    if (g->cfg->structs > 0) {
+      fprintf(g->out, "s.%c", randBelow(g, 2) ? 'x' : 'y');
+      break;
+    }
+    fprintf(g->out, "a");
+    break;
+  case 3:
+    // Only call functions defined before this one, so nothing recurses
+    if (g->func > 0) {
+      fprintf(g->out, "call fn%i_%i(a, b)", g->file, randBelow(g, g->func));
+      break;
+    }
+    fprintf(g->out, "b");
+    break;
+  case 4:
+    if (loops > 0) {
+      fprintf(g->out, "i%i", randBelow(g, loops) + 1);
+      break;
+    }
+    fprintf(g->out, "%i", randBelow(g, 100));
+    break;
+  default:
+    if (vars > 0) {
+      fprintf(g->out, "v%i", randBelow(g, vars));
+      break;
+    }
+    fprintf(g->out, "a");
+  }
+}
+
+void genExpression(Gen *g, int vars, int loops) {
+  char ops[] = {'+', '-', '*'};
+  int open = 0;
+
+  for (int i = 0; i < g->cfg->exprLen; ++i) {
+    if (i > 0) {
+      fprintf(g->out, " %c ", ops[randBelow(g, sizeof(ops))]);
+    }
+
+    // Bracket some of the operands, so precedence has something to do
+    if (i + 1 < g->cfg->exprLen && randBelow(g, 4) == 0) {
+      fputc('(', g->out);
+      ++open;
+    }
+
+    genOperand(g, vars, loops);
+
+    if (open > 0 && randBelow(g, 3) == 0) {
+      fputc(')', g->out);
+      --open;
+    }
+  }
+
+  for (; open > 0; --open) {
+    fputc(')', g->out);
+  }
+}
+
+// Alternates between if statements and for loops, declaring a variable at
+// each level so scopes get deeper too
+void genNested(Gen *g, int level, int loops) {
+  if (level > g->cfg->depth) {
+    return;
+  }
+
+  indent(g, level);
+  if (level % 2) {
+    fprintf(g->out, "if (v%i < %i) {\n", level - 1, randBelow(g, 100));
+  } else {
+    ++loops;
+    fprintf(g->out, "for (let int i%i = 0; i%i < %i; ++i%i) {\n", loops,
+            loops, randBelow(g, 10) + 1, loops);
+  }
+
+  indent(g, level + 1);
+  fprintf(g->out, "let int v%i = ", level);
+  genExpression(g, level, loops);
+  fprintf(g->out, ";\n");
+
+  genNested(g, level + 1, loops);
+
+  indent(g, level + 1);
+  fprintf(g->out, "v0 = v0 + v%i;\n", level);
+
+  indent(g, level);
+  fprintf(g->out, "}\n");
+}
+
+void genFunction(Gen *g) {
+  fprintf(g->out, "fun fn%i_%i(int a, int b) int {\n", g->file, g->func);
+
+  if (g->cfg->structs > 0) {
+    int s = g->func % g->cfg->structs;
+    fprintf(g->out, "\tlet S%i_%i s = new S%i_%i(a, b, nil);\n", g->file, s,
+            g->file, s);
+  }
+
+  fprintf(g->out, "\tlet int v0 = ");
+  genExpression(g, 0, 0);
+  fprintf(g->out, ";\n");
+
+  genNested(g, 1, 0);
+
+  fprintf(g->out, "\treturn v0;\n}\n\n");
+}
+
+void genStruct(Gen *g, int s) {
+  fprintf(g->out, "struct S%i_%i {\n\tint x,\n\tint y,\n\t^S%i_%i next,\n}\n\n",
+          g->file, s, g->file, s);
+}
+
+void genEnum(Gen *g, int e) {
+  fprintf(g->out, "enum E%i_%i {\n", g->file, e);
+  for (int m = 0; m < g->cfg->enumMembers; ++m) {
+    fprintf(g->out, "\te%i_%i_%i,\n", g->file, e, m);
+  }
+  fprintf(g->out, "}\n\n");
+}
+
+// Calls the last function in every file, functions have to be defined before
+// they're called so this goes in the last file
+void genMain(Gen *g) {
+  fprintf(g->out, "fun main() {\n\tlet int total = 0;\n");
+  if (g->cfg->funcs > 0) {
+    for (int f = 0; f < g->cfg->files; ++f) {
+      fprintf(g->out, "\ttotal = total + call fn%i_%i(total, %i);\n", f,
+              g->cfg->funcs - 1, f);
+    }
+  }
+  fprintf(g->out, "}\n");
+}
+
+errno_t generateFile(Gen *g, char *dir) {
+  // Padded so that a shell glob gives the files in order
+  char path[1024];
+  snprintf(path, sizeof(path), "%s/gen%04i.nav", dir, g->file);
+
+  if (fopen_s(&g->out, path, "w")) {
+    return 1;
+  }
+
+  for (int e = 0; e < g->cfg->enums; ++e) {
+    genEnum(g, e);
+  }
+
+  for (int s = 0; s < g->cfg->structs; ++s) {
+    genStruct(g, s);
+  }
+
+  for (g->func = 0; g->func < g->cfg->funcs; ++g->func) {
+    genFunction(g);
+  }
+
+  if (g->file == g->cfg->files - 1) {
+    genMain(g);
+  }
+
+  fclose(g->out);
+  return 0;
+}
+
+errno_t generateProgram(GenConfig *cfg, char *dir) {
+  // xorshift gets stuck on 0
+  Gen g = {cfg, NULL, 0, 0, cfg->seed ? cfg->seed : 1};
+
+  for (g.file = 0; g.file < cfg->files; ++g.file) {
+    if (generateFile(&g, dir)) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+errno_t makeDir(char *dir) {
+#ifdef _WIN32
+  if (_mkdir(dir) && errno != EEXIST) {
+#else
+  if (mkdir(dir, 0777) && errno != EEXIST) {
+#endif
+    return 1;
+  }
+
+  return 0;
+}
+
+typedef struct GenOption {
+  char *name;
+  char *help;
+  int offset;
+} GenOption;
+
+const GenOption genOptions[] = {
+    {"--files", "Source files", offsetof(GenConfig, files)},
+    {"--funcs", "Functions per file", offsetof(GenConfig, funcs)},
+    {"--structs", "Structs per file", offsetof(GenConfig, structs)},
+    {"--enums", "Enums per file", offsetof(GenConfig, enums)},
+    {"--members", "Members per enum", offsetof(GenConfig, enumMembers)},
+    {"--depth", "Nesting depth in each function", offsetof(GenConfig, depth)},
+    {"--expr", "Operands per expression", offsetof(GenConfig, exprLen)},
+    {"--seed", "Random seed", offsetof(GenConfig, seed)},
+};
+
+#define GEN_OPTION_COUNT (int)(sizeof(genOptions) / sizeof(GenOption))
+
+int readGenOption(GenConfig *cfg, int argc, char *argv[], int i) {
+  for (int j = 0; j < GEN_OPTION_COUNT; ++j) {
+    if (strcmp(argv[i], genOptions[j].name)) {
+      continue;
+    }
+
+    if (i + 1 == argc || atoi(argv[i + 1]) < 0) {
+      printf("%s expects a number that isn't negative\n", argv[i]);
+      exit(1);
+    }
+
+    *(int *)((char *)cfg + genOptions[j].offset) = atoi(argv[i + 1]);
+    return 2;
+  }
+
+  return 0;
+}
+
+void printGenOptions(void) {
+  GenConfig def = DEFAULT_GEN_CONFIG;
+
+  for (int j = 0; j < GEN_OPTION_COUNT; ++j) {
+    printf("  %-12s N  %s (default %i)\n", genOptions[j].name,
+           genOptions[j].help, *(int *)((char *)&def + genOptions[j].offset));
+  }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <corecrt.h>
+
+// Generates large, valid Nav programs for benchmarking the compiler. The same
+// config and seed always give the same program
+
+typedef struct GenConfig {
+  int files;       // Source files, main goes in the last one
+  int funcs;       // Functions in each file
+  int structs;     // Structs in each file
+  int enums;       // Enums in each file
+  int enumMembers; // Members in each enum
+  int depth;       // How deeply statements are nested in each function
+  int exprLen;     // Operands in each generated expression
+  unsigned int seed;
+} GenConfig;
+
+#define DEFAULT_GEN_CONFIG (GenConfig){8, 16, 4, 2, 16, 3, 8, 1}
+
+// Writes cfg.files files named gen0000.nav, gen0001.nav... into dir, which
+// must already exist
+errno_t generateProgram(GenConfig *cfg, char *dir);
+
+// Makes a directory, it's fine if it's already there
+errno_t makeDir(char *dir);
+
+// Reads an option like --funcs 10 into the config, returns how many arguments
+// were used, or 0 if arg isn't a generator option
+int readGenOption(GenConfig *cfg, int argc, char *argv[], int i);
+
+// Lists the generator options for the usage message
+void printGenOptions(void);
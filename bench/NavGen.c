@@ -0,0 +1,42 @@
+#include "Generator.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Writes a generated Nav program to a directory, so it can be compiled by hand.
+// Build it from NavGen.c and Generator.c
+//
+//   navgen [options] dir
+int main(int argc, char *argv[]) {
+  GenConfig cfg = DEFAULT_GEN_CONFIG;
+  char *dir = NULL;
+
+  for (int i = 1; i < argc; ++i) {
+    int used = readGenOption(&cfg, argc, argv, i);
+    if (used) {
+      i += used - 1;
+      continue;
+    }
+
+    if (argv[i][0] == '-' || dir != NULL) {
+      printf("Usage: navgen [options] dir\n");
+      printGenOptions();
+      return 1;
+    }
+
+    dir = argv[i];
+  }
+
+  if (dir == NULL) {
+    printf("Usage: navgen [options] dir\n");
+    printGenOptions();
+    return 1;
+  }
+
+  if (makeDir(dir) || generateProgram(&cfg, dir)) {
+    printf("Couldn't write the program to %s\n", dir);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,342 @@
+#include "../src/TimeReport.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <errno.h>
+#define chdir _chdir
+#define EXE_PREFIX ""
+#else
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define EXE_PREFIX "./"
+#endif
+
+// Times how fast the compiler's output runs. Each program in the corpus is
+// compiled to C with the optimiser on and off, built with the local C compiler
+// and run, next to a handwritten C version of the same program. The output of
+// each run has to match the handwritten version's, otherwise it's reported as
+// wrong rather than timed
+//
+//   runbench [options] nav corpusDir workDir [program...]
+//
+// Everything built is kept in workDir. Build it from RunBench.c,
+// ../src/TimeReport.c and ../src/Panic.c
+
+#define PATH_SIZE 1024
+#define COMMAND_SIZE (PATH_SIZE * 3)
+
+// Every program has a .nav and a .c in the corpus
+const char *programs[] = {"nbody", "binarytrees", "sieve", "sort", "structs"};
+
+#define PROGRAM_COUNT (int)(sizeof(programs) / sizeof(char *))
+
+typedef enum Outcome {
+  OUT_TIMED,
+  OUT_NAV_FAILED,
+  OUT_BUILD_FAILED,
+  OUT_WRONG,
+} Outcome;
+
+typedef struct Result {
+  Outcome outcome;
+  double ms; // Fastest run
+} Result;
+
+typedef struct RunBench {
+  char nav[PATH_SIZE];
+  char corpus[PATH_SIZE];
+  char *cc; // printf template, the executable then the C file
+  int runs;
+} RunBench;
+
+void printUsage(void) {
+  printf("Usage: runbench [options] nav corpusDir workDir [program...]\n");
+  printf("  --cc TEMPLATE  Builds a C file, the first %%s is the executable "
+         "and the\n                 second the C file (default \"cc -O2 -w -o "
+         "%%s %%s\")\n");
+  printf("  --runs N       Runs of each program, the fastest is kept (default "
+         "3)\n");
+}
+
+// Formats into a buffer of size characters, failing instead of cutting the
+// result short
+errno_t formatPath(char *dest, int size, const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(dest, size, format, args);
+  va_end(args);
+
+  return len < 0 || len >= size;
+}
+
+errno_t fullPath(char *dest, char *path) {
+#ifdef _WIN32
+  return _fullpath(dest, path, PATH_SIZE) == NULL;
+#else
+  // realpath can write up to PATH_MAX, which may be more than PATH_SIZE
+  char *full = realpath(path, NULL);
+  if (full == NULL) {
+    return 1;
+  }
+
+  errno_t err = formatPath(dest, PATH_SIZE, "%s", full);
+  free(full);
+  return err;
+#endif
+}
+
+errno_t makeDir(char *dir) {
+#ifdef _WIN32
+  if (_mkdir(dir) && errno != EEXIST) {
+#else
+  if (mkdir(dir, 0777) && errno != EEXIST) {
+#endif
+    return 1;
+  }
+
+  return 0;
+}
+
+// Reads a whole file, the result must be freed
+char *readFile(char *path, long *len) {
+  FILE *f;
+  if (fopen_s(&f, path, "rb")) {
+    return NULL;
+  }
+
+  fseek(f, 0, SEEK_END);
+  *len = ftell(f);
+  fseek(f, 0, SEEK_SET);
+
+  char *data = malloc(*len > 0 ? *len : 1);
+  if (data == NULL || fread(data, 1, *len, f) != (size_t)*len) {
+    free(data);
+    fclose(f);
+    return NULL;
+  }
+
+  fclose(f);
+  return data;
+}
+
+bool sameFile(char *a, char *b) {
+  long aLen, bLen;
+  char *aData = readFile(a, &aLen);
+  char *bData = readFile(b, &bLen);
+
+  bool same = aData != NULL && bData != NULL && aLen == bLen &&
+              !memcmp(aData, bData, aLen);
+
+  free(aData);
+  free(bData);
+  return same;
+}
+
+// The emitted code calls print without declaring it, so it's given printf
+errno_t writeDriver(char *dest, char *emitted) {
+  long len;
+  char *data = readFile(emitted, &len);
+  if (data == NULL) {
+    return 1;
+  }
+
+  FILE *f;
+  if (fopen_s(&f, dest, "w")) {
+    free(data);
+    return 1;
+  }
+
+  fprintf(f, "#include <stdio.h>\n#define print printf\n\n");
+  fwrite(data, 1, len, f);
+  fclose(f);
+
+  free(data);
+  return 0;
+}
+
+// Builds a C file and runs it, checking its output against expected unless
+// that's NULL
+Result buildAndTime(RunBench *rb, char *exe, char *source, char *output,
+                    char *expected) {
+  char command[COMMAND_SIZE];
+
+  int len = snprintf(command, sizeof(command), rb->cc, exe, source);
+  if (len >= (int)sizeof(command) ||
+      snprintf(command + len, sizeof(command) - len, " > %s.build.log 2>&1",
+               exe) >= (int)sizeof(command) - len ||
+      system(command)) {
+    return (Result){OUT_BUILD_FAILED, 0};
+  }
+
+  if (formatPath(command, sizeof(command), "%s%s > %s", EXE_PREFIX, exe,
+                 output)) {
+    return (Result){OUT_BUILD_FAILED, 0};
+  }
+
+  Result r = {OUT_TIMED, -1};
+  for (int run = 0; run < rb->runs; ++run) {
+    // The exit code isn't checked, Nav's main doesn't return anything
+    double start = wallSeconds();
+    system(command);
+    double ms = (wallSeconds() - start) * 1000;
+
+    if (r.ms < 0 || ms < r.ms) {
+      r.ms = ms;
+    }
+
+    if (run == 0 && expected != NULL && !sameFile(output, expected)) {
+      return (Result){OUT_WRONG, 0};
+    }
+  }
+
+  return r;
+}
+
+// Compiles the Nav version of a program and times the result
+Result runNav(RunBench *rb, const char *name, bool optimise, char *expected) {
+  char *suffix = optimise ? "opt" : "noopt";
+  char command[COMMAND_SIZE];
+
+  // The compiler writes to ../output/main.c, so it's run from inside src
+  if (formatPath(command, sizeof(command),
+                 "cd src && \"%s\"%s \"%s/%s.nav\" > ../%s_%s.log 2>&1",
+                 rb->nav, optimise ? "" : " --no-optimise", rb->corpus, name,
+                 name, suffix) ||
+      system(command)) {
+    return (Result){OUT_NAV_FAILED, 0};
+  }
+
+  char exe[PATH_SIZE], source[PATH_SIZE], output[PATH_SIZE];
+  if (formatPath(exe, sizeof(exe), "%s_%s", name, suffix) ||
+      formatPath(source, sizeof(source), "%s_%s.c", name, suffix) ||
+      formatPath(output, sizeof(output), "%s_%s.txt", name, suffix) ||
+      writeDriver(source, "output/main.c")) {
+    return (Result){OUT_NAV_FAILED, 0};
+  }
+
+  return buildAndTime(rb, exe, source, output, expected);
+}
+
+void printResult(Result r, double baseline) {
+  char cell[32];
+
+  switch (r.outcome) {
+  case OUT_TIMED:
+    if (baseline > 0) {
+      snprintf(cell, sizeof(cell), "%.1f (%.2fx)", r.ms, r.ms / baseline);
+    } else {
+      snprintf(cell, sizeof(cell), "%.1f", r.ms);
+    }
+    break;
+  case OUT_NAV_FAILED:
+    snprintf(cell, sizeof(cell), "nav failed");
+    break;
+  case OUT_BUILD_FAILED:
+    snprintf(cell, sizeof(cell), "build failed");
+    break;
+  case OUT_WRONG:
+    snprintf(cell, sizeof(cell), "wrong output");
+    break;
+  }
+
+  printf(" %20s", cell);
+}
+
+void runProgram(RunBench *rb, const char *name) {
+  char exe[PATH_SIZE], source[PATH_SIZE], expected[PATH_SIZE];
+  if (formatPath(exe, sizeof(exe), "%s_c", name) ||
+      formatPath(source, sizeof(source), "%s/%s.c", rb->corpus, name) ||
+      formatPath(expected, sizeof(expected), "%s_c.txt", name)) {
+    printf("%-14s path too long\n", name);
+    return;
+  }
+
+  Result c = buildAndTime(rb, exe, source, expected, NULL);
+  Result opt = runNav(rb, name, true, expected);
+  Result noopt = runNav(rb, name, false, expected);
+
+  printf("%-14s", name);
+  printResult(c, 0);
+  printResult(opt, c.outcome == OUT_TIMED ? c.ms : 0);
+  printResult(noopt, c.outcome == OUT_TIMED ? c.ms : 0);
+  printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+  RunBench rb;
+  rb.cc = "cc -O2 -w -o %s %s";
+  rb.runs = 3;
+
+  char *args[3];
+  int argCount = 0;
+  char **only = argv + argc;
+  int onlyCount = 0;
+
+  for (int i = 1; i < argc; ++i) {
+    if (i + 1 < argc && !strcmp(argv[i], "--cc")) {
+      rb.cc = argv[++i];
+      continue;
+    }
+
+    if (i + 1 < argc && !strcmp(argv[i], "--runs")) {
+      rb.runs = atoi(argv[++i]);
+      continue;
+    }
+
+    if (argv[i][0] == '-') {
+      printUsage();
+      return 1;
+    }
+
+    // Anything after the directories picks which programs to run
+    if (argCount == 3) {
+      only = argv + i;
+      onlyCount = argc - i;
+      break;
+    }
+
+    args[argCount] = argv[i];
+    ++argCount;
+  }
+
+  if (argCount != 3 || rb.runs < 1) {
+    printUsage();
+    return 1;
+  }
+
+  // The work directory becomes the current one, so the others have to be
+  // found first
+  if (fullPath(rb.nav, args[0]) || fullPath(rb.corpus, args[1])) {
+    printf("Couldn't find %s or %s\n", args[0], args[1]);
+    return 1;
+  }
+
+  if (makeDir(args[2]) || chdir(args[2]) || makeDir("src") ||
+      makeDir("output")) {
+    printf("Couldn't set up the work directory %s\n", args[2]);
+    return 1;
+  }
+
+  printf("%-14s %20s %20s %20s\n", "Program", "C (ms)", "Optimised (ms)",
+         "Unoptimised (ms)");
+
+  for (int i = 0; i < PROGRAM_COUNT; ++i) {
+    bool chosen = onlyCount == 0;
+    for (int j = 0; j < onlyCount; ++j) {
+      chosen = chosen || !strcmp(only[j], programs[i]);
+    }
+
+    if (chosen) {
+      runProgram(&rb, programs[i]);
+    }
+  }
+
+  return 0;
+}
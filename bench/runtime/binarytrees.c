@@ -0,0 +1,60 @@
+// Handwritten equivalent of binarytrees.nav
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct Tree {
+  struct Tree *left;
+  struct Tree *right;
+} Tree;
+
+Tree *newTree(Tree *left, Tree *right) {
+  Tree *t = malloc(sizeof(Tree));
+  t->left = left;
+  t->right = right;
+  return t;
+}
+
+Tree *bottomUp(int depth) {
+  if (depth == 0) {
+    return newTree(NULL, NULL);
+  }
+
+  return newTree(bottomUp(depth - 1), bottomUp(depth - 1));
+}
+
+int check(Tree *t) {
+  if (t->left == NULL) {
+    return 1;
+  }
+
+  return 1 + check(t->left) + check(t->right);
+}
+
+void destroy(Tree *t) {
+  if (t->left != NULL) {
+    destroy(t->left);
+    destroy(t->right);
+  }
+  free(t);
+}
+
+int main(void) {
+  int total = 0;
+
+  for (int depth = 4; depth <= 18; depth = depth + 2) {
+    int iterations = 1;
+    for (int i = depth; i < 18; ++i) {
+      iterations = iterations * 2;
+    }
+
+    for (int i = 0; i < iterations; ++i) {
+      Tree *t = bottomUp(depth);
+      total = total + check(t);
+      destroy(t);
+    }
+  }
+
+  printf("%i\n", total);
+
+  return 0;
+}
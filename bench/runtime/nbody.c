@@ -0,0 +1,76 @@
+// Handwritten equivalent of nbody.nav
+#include <stdio.h>
+
+typedef struct Body {
+  float x, y, z;
+  float vx, vy, vz;
+  float mass;
+} Body;
+
+float root(float v) {
+  float r = v;
+  if (r < 1.0) {
+    r = 1.0;
+  }
+  for (int i = 0; i < 12; ++i) {
+    r = (r + v / r) * 0.5;
+  }
+  return r;
+}
+
+void pull(Body *a, Body *b, float dt) {
+  float dx = a->x - b->x;
+  float dy = a->y - b->y;
+  float dz = a->z - b->z;
+  float dist2 = dx * dx + dy * dy + dz * dz;
+  float mag = dt / (dist2 * root(dist2));
+
+  a->vx = a->vx - dx * b->mass * mag;
+  a->vy = a->vy - dy * b->mass * mag;
+  a->vz = a->vz - dz * b->mass * mag;
+
+  b->vx = b->vx + dx * a->mass * mag;
+  b->vy = b->vy + dy * a->mass * mag;
+  b->vz = b->vz + dz * a->mass * mag;
+}
+
+void move(Body *b, float dt) {
+  b->x = b->x + dt * b->vx;
+  b->y = b->y + dt * b->vy;
+  b->z = b->z + dt * b->vz;
+}
+
+float energy(Body *b) {
+  return 0.5 * b->mass * (b->vx * b->vx + b->vy * b->vy + b->vz * b->vz);
+}
+
+int main(void) {
+  Body bodies[] = {
+      {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 39.47},
+      {4.84, -1.16, -0.10, 0.60, 2.81, -0.02, 0.037},
+      {8.34, 4.12, -0.40, -1.01, 1.82, 0.008, 0.011},
+      {12.89, -15.11, -0.22, 1.08, 0.86, -0.01, 0.0017},
+      {15.37, -25.91, 0.17, 0.97, 0.59, -0.03, 0.002},
+  };
+  int count = sizeof(bodies) / sizeof(Body);
+
+  for (int step = 0; step < 1000000; ++step) {
+    for (int i = 0; i < count; ++i) {
+      for (int j = i + 1; j < count; ++j) {
+        pull(bodies + i, bodies + j, 0.01);
+      }
+    }
+
+    for (int i = 0; i < count; ++i) {
+      move(bodies + i, 0.01);
+    }
+  }
+
+  float e = 0;
+  for (int i = 0; i < count; ++i) {
+    e = e + energy(bodies + i);
+  }
+  printf("%.3f\n", e);
+
+  return 0;
+}
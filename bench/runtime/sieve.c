@@ -0,0 +1,29 @@
+// Handwritten equivalent of sieve.nav
+#include <stdbool.h>
+#include <stdio.h>
+
+int main(void) {
+  bool composite[128];
+  int total = 0;
+
+  for (int round = 0; round < 800000; ++round) {
+    for (int i = 0; i < 128; ++i) {
+      composite[i] = false;
+    }
+
+    for (int i = 2; i < 128; ++i) {
+      if (!composite[i]) {
+        total = total + i;
+        for (int j = i * i; j < 128; j = j + i) {
+          composite[j] = true;
+        }
+      }
+    }
+
+    total = total % 1000003;
+  }
+
+  printf("%i\n", total);
+
+  return 0;
+}
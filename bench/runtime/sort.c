@@ -0,0 +1,34 @@
+// Handwritten equivalent of sort.nav
+#include <stdio.h>
+
+int main(void) {
+  int numbers[128];
+  int seed = 1;
+  int total = 0;
+
+  for (int round = 0; round < 20000; ++round) {
+    for (int i = 0; i < 128; ++i) {
+      seed = (seed * 75 + 74) % 65537;
+      numbers[i] = seed;
+    }
+
+    for (int i = 1; i < 128; ++i) {
+      int cur = numbers[i];
+      int j = i;
+      for (; j > 0; j = j - 1) {
+        int prev = numbers[j - 1];
+        if (prev <= cur) {
+          break;
+        }
+        numbers[j] = prev;
+      }
+      numbers[j] = cur;
+    }
+
+    total = (total + numbers[0] + numbers[64] + numbers[127]) % 1000003;
+  }
+
+  printf("%i\n", total);
+
+  return 0;
+}
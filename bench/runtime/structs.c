@@ -0,0 +1,43 @@
+// Handwritten equivalent of structs.nav
+#include <stdio.h>
+
+typedef struct Link {
+  int value;
+  struct Link *next;
+} Link;
+
+int chase(Link *start, int steps) {
+  Link *cur = start;
+  int total = 0;
+
+  for (int i = 0; i < steps; ++i) {
+    total = (total + cur->value) % 1000003;
+    cur = cur->next;
+  }
+
+  return total;
+}
+
+int main(void) {
+  Link a = {3, NULL};
+  Link b = {14, NULL};
+  Link c = {15, NULL};
+  Link d = {92, NULL};
+  Link e = {65, NULL};
+  Link f = {35, NULL};
+  Link g = {89, NULL};
+  Link h = {79, NULL};
+
+  a.next = &e;
+  e.next = &c;
+  c.next = &h;
+  h.next = &b;
+  b.next = &g;
+  g.next = &d;
+  d.next = &f;
+  f.next = &a;
+
+  printf("%i\n", chase(&a, 100000000));
+
+  return 0;
+}
@@ -3,7 +3,9 @@
 #include "Fun.h"
 #include "Ident.h"
 #include "Node.h"
+#include "Stats.h"
 #include "StringManager.h"
+#include "Trace.h"
 #include "TypeModifier.h"
 #include "Types.h"
 
@@ -24,9 +26,10 @@ void analyserInit(Analyser *a, Node enums, Node structs, Node funcs,
   a->inEnums = enums;
   a->inStructs = structs;
   a->inFuns = funcs;
-  a->vars = (IdentStack){NULL, 0};
-  a->types = (TypeStack){NULL, 0};
-  a->funs = (FunStack){NULL, 0};
+  arenaInit(&a->arena, SUB_ANALYSER);
+  a->vars = (IdentStack){NULL, 0, &a->arena};
+  a->types = (TypeStack){NULL, 0, &a->arena};
+  a->funs = (FunStack){NULL, 0, &a->arena};
   a->sm = sm;
 
   typeStackPush(&a->types, TK_ABS, getString(sm, "int"), TM_NONE, NULL);
@@ -80,56 +83,75 @@ void analyseDefaultBlock(Analyser *a, Context c, Node *n);
 void analyseBlock(Analyser *a, Context c, Node *n);
 void analyseOperator(Analyser *a, Context c, Node *n, Type *left, Type *right);
 
+// probes is how many stack entries a lookup checked
+void countScopeLookup(int probes) {
+  STAT_COUNT(COUNT_SCOPE_LOOKUPS, 1)
+  STAT_COUNT(COUNT_SCOPE_PROBES, probes)
+  STAT_MAX(MAX_SCOPE_PROBE, probes)
+}
+
 Ident *varExists(Analyser *a, char *name) {
   // printf("Start\n");
 
   Ident *curIdent = a->vars.tail;
+  int probes = 0;
 
   while (curIdent != NULL) {
+    ++probes;
+
     // printf("%s\n", curIdent->name->data);
-    if (cmpStr(curIdent->name, name)) {
-      return curIdent;
+    if (SAME_SYMBOL(curIdent->name, name)) {
+      break;
     }
 
     // Next identifier
     curIdent = curIdent->next;
   }
 
-  return NULL;
+  countScopeLookup(probes);
+  return curIdent;
 }
 
 Fun *funExists(Analyser *a, char *name) {
   Fun *curFun = a->funs.tail;
+  int probes = 0;
 
   while (curFun != NULL) {
-    if (cmpStr(curFun->name, name)) {
-      return curFun;
+    ++probes;
+
+    if (SAME_SYMBOL(curFun->name, name)) {
+      break;
     }
 
     // Next identifier
     curFun = curFun->next;
   }
 
-  return NULL;
+  countScopeLookup(probes);
+  return curFun;
 }
 
 Type *typeExists(Analyser *a, char *name) {
   Type *curType = a->types.tail;
+  int probes = 0;
 
   // printf("Checking type exists: %s\n", name);
 
   while (curType != NULL) {
+    ++probes;
+
     // printf("\tChecking against: %s\n", curType->name);
 
-    if (cmpStr(curType->name, name)) {
-      return curType;
+    if (SAME_SYMBOL(curType->name, name)) {
+      break;
     }
 
     // Next identifier
     curType = curType->next;
   }
 
-  return NULL;
+  countScopeLookup(probes);
+  return curType;
 }
 
 void analyseEnums(Analyser *a) {
@@ -141,7 +163,7 @@ void analyseEnums(Analyser *a) {
 
   for (int i = 0; i < a->inEnums.children.len; ++i) {
     enumNode = a->inEnums.children.p + i;
-    enumName = enumNode->children.p[1].data;
+    enumName = enumNode->children.p[DEF_NAME].data;
 
     // printf("Analysing enum %s\n", enumName);
 
@@ -155,7 +177,7 @@ void analyseEnums(Analyser *a) {
     enumType = a->types.tail;
 
     // Each of the constants in the enum
-    for (int j = 3; j < enumNode->children.len - 1; j += 2) {
+    for (int j = DEF_BODY; j < enumNode->children.len; ++j) {
       enumChildNode = enumNode->children.p + j;
 
       Ident *exists = varExists(a, enumChildNode->data);
@@ -180,7 +202,7 @@ void analyseStructs(Analyser *a) {
 
   for (int i = 0; i < a->inStructs.children.len; ++i) {
     structNode = a->inStructs.children.p + i;
-    structName = structNode->children.p[1].data;
+    structName = structNode->children.p[DEF_NAME].data;
 
     if (typeExists(a, structName)) {
       throwAnalyserError(a, structNode->sourceName, structNode->line, FUNC_NAME,
@@ -188,27 +210,23 @@ void analyseStructs(Analyser *a) {
     }
 
     // Add the struct as a type
-    typeStackPush(&a->types, TK_ABS, structNode->children.p[1].data, TM_NONE,
-                  NULL);
+    typeStackPush(&a->types, TK_ABS, structName, TM_NONE, NULL);
     structType = a->types.tail;
 
-    // Each property of this struct
-    numProps = structNode->children.len - 4;
+    // Each property of this struct, (complexType, Identifier)
+    numProps = (structNode->children.len - DEF_BODY) / 2;
 
     // Empty struct
-    if (numProps == 0 || numProps == 1) {
+    if (numProps == 0) {
       continue;
     }
 
-    // (complexType, Identifier, comma)
-    numProps = (numProps + 1) / 3;
-
-    structType->props = malloc(sizeof(Ident) * numProps);
+    structType->props = arenaAlloc(&a->arena, sizeof(Ident) * numProps);
     structType->propsLen = numProps;
 
     for (int j = 0; j < numProps; ++j) {
-      propTypeNode = structNode->children.p + 3 + (j * 3);
-      propNode = structNode->children.p + 4 + (j * 3);
+      propTypeNode = structNode->children.p + DEF_BODY + (j * 2);
+      propNode = propTypeNode + 1;
 
       structType->props[j] = (Ident){
           propNode->data, analyseComplexType(a, ZERO_CONTEXT, propTypeNode),
@@ -231,9 +249,10 @@ void analyseFuncs(Analyser *a) {
   for (int i = 0; i < a->inFuns.children.len; ++i) {
 
     funcNode = a->inFuns.children.p + i;
-    funcName = funcNode->children.p[1].data;
+    funcName = funcNode->children.p[DEF_NAME].data;
 
     // printf("Analysing function %s\n", funcName);
+    TRACE_BEGIN("analyse", funcName);
 
     if (funExists(a, funcName)) {
       throwAnalyserError(a, funcNode->sourceName, funcNode->line, FUNC_NAME,
@@ -241,33 +260,27 @@ void analyseFuncs(Analyser *a) {
     }
 
     // Add the function
-    funStackPush(&a->funs, funcNode->children.p[1].data);
+    funStackPush(&a->funs, funcName);
     funcDec = a->funs.tail;
 
-    // Each param of this func
-    if (funcNode->children.p[funcNode->children.len - 2].kind != N_R_PAREN) {
-      // We have a return value
-      numParams = funcNode->children.len - 5;
-
-      Node *retNode = funcNode->children.p + funcNode->children.len - 2;
-
-      funcDec->ret = analyseComplexType(a, ZERO_CONTEXT, retNode);
-
-    } else {
-      numParams = funcNode->children.len - 4;
+    // We have a return value
+    if (funcNode->children.p[FUNC_DEF_RET].kind != N_EMPTY) {
+      funcDec->ret = analyseComplexType(a, ZERO_CONTEXT,
+                                        funcNode->children.p + FUNC_DEF_RET);
     }
 
-    numParams /= 3;
+    // Each param of this func, (complexType, Identifier)
+    numParams = (funcNode->children.len - FUNC_DEF_PARAMS) / 2;
 
     // printf("Got function return type\n");
 
     if (numParams != 0) {
-      funcDec->params = malloc(sizeof(Ident) * numParams);
+      funcDec->params = arenaAlloc(&a->arena, sizeof(Ident) * numParams);
       funcDec->paramsLen = numParams;
 
       for (int j = 0; j < numParams; ++j) {
-        paramTypeNode = funcNode->children.p + 3 + (j * 3);
-        paramNode = funcNode->children.p + 4 + (j * 3);
+        paramTypeNode = funcNode->children.p + FUNC_DEF_PARAMS + (j * 2);
+        paramNode = paramTypeNode + 1;
 
         funcDec->params[j] = (Ident){
             paramNode->data, analyseComplexType(a, ZERO_CONTEXT, paramTypeNode),
@@ -286,6 +299,7 @@ void analyseFuncs(Analyser *a) {
 
       if (a->vars.len == 1) {
         a->vars.tail = funcDec->params + i;
+        TRACE_END("analyse", funcName);
         return;
       }
 
@@ -296,7 +310,8 @@ void analyseFuncs(Analyser *a) {
     int stackBase = a->vars.len;
 
     analyseBlock(a, (Context){false, false, NULL, funcDec->ret},
-                 funcNode->children.p + funcNode->children.len - 1);
+                 funcNode->children.p + FUNC_DEF_BLOCK);
+    TRACE_END("analyse", funcName);
 
     // Delete variables used in the function
     while (a->vars.len > stackBase) {
@@ -330,7 +345,7 @@ bool typeEqual(Type *t1, Type *t2) {
     return false;
   }
 
-  if (!cmpStr(t1->name, t2->name)) {
+  if (!SAME_SYMBOL(t1->name, t2->name)) {
     return false;
   }
 
@@ -348,35 +363,27 @@ void analyseForLoop(Analyser *a, Context c, Node *n) {
   // the loop header
   int stackBase = a->vars.len;
 
-  int i = 2;
-
   // Assignment
-  if (n->children.p[i].kind == N_ASSIGNMENT) {
-    analyseAssignment(a, c, n->children.p + i);
-    i += 2;
-  } else if (n->children.p[i].kind == N_NEW_ASSIGNMENT) {
-    analyseNewAssignment(a, c, n->children.p + i);
-    i += 2;
-  } else {
-    ++i;
+  Node *init = n->children.p + FOR_INIT;
+  if (init->kind == N_ASSIGNMENT) {
+    analyseAssignment(a, c, init);
+  } else if (init->kind == N_NEW_ASSIGNMENT) {
+    analyseNewAssignment(a, c, init);
   }
 
   // Expression
-  if (n->children.p[i].kind == N_EXPRESSION) {
+  if (n->children.p[FOR_COND].kind == N_EXPRESSION) {
     c.expType = a->preDefs.BOOL;
-    analyseExpression(a, c, n->children.p + i);
-    i += 2;
-  } else {
-    ++i;
+    analyseExpression(a, c, n->children.p + FOR_COND);
   }
 
   // Assignment
-  if (n->children.p[i].kind == N_ASSIGNMENT) {
-    analyseAssignment(a, c, n->children.p + i);
+  if (n->children.p[FOR_STEP].kind == N_ASSIGNMENT) {
+    analyseAssignment(a, c, n->children.p + FOR_STEP);
   }
 
   analyseBlock(a, (Context){true, true, c.expType, c.retType},
-               n->children.p + n->children.len - 1);
+               n->children.p + FOR_BLOCK);
 
   // Delete variables used in the loop
   while (a->vars.len > stackBase) {
@@ -390,7 +397,7 @@ void analyseRetState(Analyser *a, Context c, Node *n) {
   // printf("RetState %s\n", nodeCodeString(n->kind));
 
   // We don't expect a return value
-  if (c.retType == NULL && n->children.len == 3) {
+  if (c.retType == NULL && n->children.len == 1) {
     throwAnalyserError(a, n->sourceName, n->line, FUNC_NAME,
                        "This function expected no return value, but got one.");
   }
@@ -398,8 +405,8 @@ void analyseRetState(Analyser *a, Context c, Node *n) {
   // Now check the return value, and expect a type
   c.expType = c.retType;
 
-  if (n->children.p[1].kind == N_EXPRESSION) {
-    analyseExpression(a, c, n->children.p + 1);
+  if (n->children.len == 1) {
+    analyseExpression(a, c, n->children.p);
   }
 }
 
@@ -429,7 +436,7 @@ void analyseIndex(Analyser *a, Context c, Node *n) {
   // printf("Index %s\n", nodeCodeString(n->kind));
 
   c.expType = a->preDefs.INT;
-  analyseExpression(a, c, n->children.p + 1);
+  analyseExpression(a, c, n->children.p);
 }
 
 void analyseIfBlock(Analyser *a, Context c, Node *n) {
@@ -437,25 +444,17 @@ void analyseIfBlock(Analyser *a, Context c, Node *n) {
 
   int stackBase = a->vars.len;
 
-  c.expType = a->preDefs.BOOL;
-  analyseExpression(a, c, n->children.p + 2);
-  analyseBlock(a, c, n->children.p + 4);
-
-  int i = 5;
-
-  while (n->children.len > i) {
-    if (n->children.p[i].kind == N_ELIF) {
-      c.expType = a->preDefs.BOOL;
-      analyseExpression(a, c, n->children.p + i + 2);
-      analyseBlock(a, c, n->children.p + i + 4);
-
-      i += 5;
-    } else if (n->children.p[i].kind == N_ELSE) {
-
-      analyseBlock(a, c, n->children.p + i + 1);
+  // The if and each elif
+  int i = 0;
+  for (; i + IF_THEN < n->children.len; i += IF_STEP) {
+    c.expType = a->preDefs.BOOL;
+    analyseExpression(a, c, n->children.p + i + IF_COND);
+    analyseBlock(a, c, n->children.p + i + IF_THEN);
+  }
 
-      break;
-    }
+  // Else
+  if (i < n->children.len) {
+    analyseBlock(a, c, n->children.p + i);
   }
 
   // Delete variables used in the if block
@@ -471,16 +470,16 @@ void analyseCrement(Analyser *a, Context c, Node *n) {
 
   Type *type = NULL;
 
-  if (n->children.p[1].kind == N_IDENTIFIER) {
-    Ident *var = varExists(a, n->children.p[1].data);
+  if (n->children.p[CREMENT_TARGET].kind == N_IDENTIFIER) {
+    Ident *var = varExists(a, n->children.p[CREMENT_TARGET].data);
     if (var == NULL) {
-      printf("\nVariable name: %s\n\n", n->children.p[1].data);
-      throwAnalyserError(a, n->sourceName, n->children.p[1].line, FUNC_NAME,
-                         "Variable doesn't exist");
+      printf("\nVariable name: %s\n\n", n->children.p[CREMENT_TARGET].data);
+      throwAnalyserError(a, n->sourceName, n->children.p[CREMENT_TARGET].line,
+                         FUNC_NAME, "Variable doesn't exist");
     }
     type = var->type;
   } else { // Access
-    type = analyseAccess(a, c, n->children.p + 1);
+    type = analyseAccess(a, c, n->children.p + CREMENT_TARGET);
   }
 
   if (type != a->preDefs.INT) {
@@ -510,30 +509,31 @@ void analyseNewAssignment(Analyser *a, Context c, Node *n) {
   // printf("%s\n", out);
   // free(out);
 
-  char *varName = n->children.p[2].data;
+  Node *nameNode = n->children.p + NEW_ASSIGNMENT_NAME;
+  char *varName = nameNode->data;
 
   if (varExists(a, varName) != NULL) {
-    throwAnalyserError(a, n->sourceName, n->children.p[2].line, FUNC_NAME,
+    throwAnalyserError(a, n->sourceName, nameNode->line, FUNC_NAME,
                        "Variable name already exists");
   }
 
-  Type *t = analyseComplexType(a, c, n->children.p + 1);
+  Type *t = analyseComplexType(a, c, n->children.p + NEW_ASSIGNMENT_TYPE);
 
   // Expect the correct type from expression
   c.expType = t;
 
   // printf("Got new var type\n");
 
-  Type *exprType = analyseExpression(a, c, n->children.p + n->children.len - 1);
+  Type *exprType = analyseExpression(a, c, n->children.p + NEW_ASSIGNMENT_EXPR);
   if (exprType != t) {
     printf("\nExpected type %s\n", typeString(t));
     printf("Recieved type %s\n\n", typeString(exprType));
     throwAnalyserError(a, n->sourceName,
-                       n->children.p[n->children.len - 1].line, FUNC_NAME,
+                       n->children.p[NEW_ASSIGNMENT_EXPR].line, FUNC_NAME,
                        "Expression in assignment wasn't correct type");
   }
 
-  identStackPush(&a->vars, n->children.p[2].data, t);
+  identStackPush(&a->vars, varName, t);
 
   // printf("End NewAssign %s\n", nodeCodeString(n->kind));
 }
@@ -543,31 +543,31 @@ void analyseAssignment(Analyser *a, Context c, Node *n) {
 
   // printf("Assign %s\n", nodeCodeString(n->kind));
 
-  if (n->children.p[0].kind == N_CREMENT) {
-    analyseCrement(a, c, n->children.p);
+  if (n->children.p[ASSIGN_TARGET].kind == N_CREMENT) {
+    analyseCrement(a, c, n->children.p + ASSIGN_TARGET);
     return;
   }
 
   Type *varType = NULL;
 
-  if (n->children.p[0].kind == N_IDENTIFIER) {
-    char *varName = n->children.p[0].data;
+  if (n->children.p[ASSIGN_TARGET].kind == N_IDENTIFIER) {
+    char *varName = n->children.p[ASSIGN_TARGET].data;
     Ident *var = varExists(a, varName);
     if (var == NULL) {
-      throwAnalyserError(a, n->sourceName, n->children.p[0].line, FUNC_NAME,
-                         "Variable does not exists");
+      throwAnalyserError(a, n->sourceName, n->children.p[ASSIGN_TARGET].line,
+                         FUNC_NAME, "Variable does not exists");
     }
     varType = var->type;
   } else { // Access
-    varType = analyseAccess(a, c, n->children.p);
+    varType = analyseAccess(a, c, n->children.p + ASSIGN_TARGET);
   }
 
-  if (n->children.p[1].kind == N_INDEX) {
+  if (n->children.p[ASSIGN_INDEX].kind == N_INDEX) {
     if (varType->mod != TM_ARRAY) {
       throwAnalyserError(a, n->sourceName, n->line, FUNC_NAME,
                          "Can't index non-array");
     }
-    analyseIndex(a, c, n->children.p + 1);
+    analyseIndex(a, c, n->children.p + ASSIGN_INDEX);
     varType = varType->parent;
   }
 
@@ -579,7 +579,7 @@ Type *analyseBracketedValue(Analyser *a, Context c, Node *n) {
   // printf("BracketedValue %s\n", nodeCodeString(n->kind));
 
   // Keep same expected type and everything
-  return analyseExpression(a, c, n->children.p + 1);
+  return analyseExpression(a, c, n->children.p);
 }
 
 void analyseLoneCall(Analyser *a, Context c, Node *n) {
@@ -593,17 +593,14 @@ void analyseSwitchState(Analyser *a, Context c, Node *n) {
 
   c.expType = NULL;
 
-  analyseExpression(a, c, n->children.p + 2);
-
-  int i = 5;
+  analyseExpression(a, c, n->children.p + SWITCH_EXPR);
 
-  while (n->children.p[i].kind == N_CASE_BLOCK) {
-    analyseCaseBlock(a, c, n->children.p + i);
-    ++i;
-  }
-
-  if (n->children.p[i].kind == N_DEFAULT_BLOCK) {
-    analyseDefaultBlock(a, c, n->children.p + i);
+  for (int i = SWITCH_CASES; i < n->children.len; ++i) {
+    if (n->children.p[i].kind == N_CASE_BLOCK) {
+      analyseCaseBlock(a, c, n->children.p + i);
+    } else {
+      analyseDefaultBlock(a, c, n->children.p + i);
+    }
   }
 }
 
@@ -613,11 +610,11 @@ void analyseCaseBlock(Analyser *a, Context c, Node *n) {
   // printf("CaseBlock %s\n", nodeCodeString(n->kind));
 
   // Expect the type of the arg to the switch
-  c.expType = analyseExpression(a, c, n->children.p + 1);
+  c.expType = analyseExpression(a, c, n->children.p + CASE_EXPR);
 
   c.canBreak = true;
 
-  for (int i = 3; i < n->children.len; ++i) {
+  for (int i = CASE_STATEMENTS; i < n->children.len; ++i) {
     switch (n->children.p[i].kind) {
     case N_LONE_CALL:
       analyseLoneCall(a, c, n->children.p + i);
@@ -658,7 +655,7 @@ void analyseDefaultBlock(Analyser *a, Context c, Node *n) {
 
   c.canBreak = true;
 
-  for (int i = 2; i < n->children.len; ++i) {
+  for (int i = 0; i < n->children.len; ++i) {
     switch (n->children.p[i].kind) {
     case N_LONE_CALL:
       analyseLoneCall(a, c, n->children.p + i);
@@ -743,9 +740,9 @@ Type *analyseAccess(Analyser *a, Context c, Node *n) {
   char *propName;
 
   Node *parentNode = n;
-  Ident *parent = varExists(a, n->children.p[0].data);
+  Ident *parent = varExists(a, n->children.p[ACCESS_BASE].data);
   Type *parentType = parent->type;
-  if (n->children.p[1].kind == N_P_ACCESSOR) {
+  if (n->children.p[ACCESS_OP].kind == N_P_ACCESSOR) {
     if (parentType->mod != TM_POINTER) {
       throwAnalyserError(a, n->sourceName, n->line, FUNC_NAME,
                          "Attempted to use pointer access on non-pointer type");
@@ -753,14 +750,15 @@ Type *analyseAccess(Analyser *a, Context c, Node *n) {
     parentType = parentType->parent;
   }
 
-  while (parentNode->children.p[2].kind == N_ACCESS) {
-    propName = parentNode->children.p[2].children.p[0].data;
+  while (parentNode->children.p[ACCESS_MEMBER].kind == N_ACCESS) {
+    propName =
+        parentNode->children.p[ACCESS_MEMBER].children.p[ACCESS_BASE].data;
 
     Ident *child = NULL;
 
     // Search through the properties of the parent for a match
     for (int i = 0; i < parentType->propsLen; ++i) {
-      if (cmpStr(parentType->props[i].name, propName)) {
+      if (SAME_SYMBOL(parentType->props[i].name, propName)) {
         child = parentType->props + i;
       }
     }
@@ -771,10 +769,10 @@ Type *analyseAccess(Analyser *a, Context c, Node *n) {
     }
 
     // Next recursion
-    parentNode = parentNode->children.p + 2;
+    parentNode = parentNode->children.p + ACCESS_MEMBER;
     parentType = child->type;
 
-    if (parentNode->children.p[1].kind == N_P_ACCESSOR) {
+    if (parentNode->children.p[ACCESS_OP].kind == N_P_ACCESSOR) {
       if (parentType->mod != TM_POINTER) {
         throwAnalyserError(
             a, n->sourceName, n->line, FUNC_NAME,
@@ -784,16 +782,16 @@ Type *analyseAccess(Analyser *a, Context c, Node *n) {
     }
   }
 
-  if (parentNode->children.p[2].kind != N_IDENTIFIER) {
+  if (parentNode->children.p[ACCESS_MEMBER].kind != N_IDENTIFIER) {
     throwAnalyserError(a, n->sourceName, n->line, FUNC_NAME,
                        "Expected an access chain to end in an identifier");
   }
 
-  propName = parentNode->children.p[2].data;
+  propName = parentNode->children.p[ACCESS_MEMBER].data;
 
   // Search through the properties of the parent for a match
   for (int i = 0; i < parentType->propsLen; ++i) {
-    if (cmpStr(parentType->props[i].name, propName)) {
+    if (SAME_SYMBOL(parentType->props[i].name, propName)) {
       return parentType->props[i].type;
     }
   }
@@ -818,7 +816,7 @@ Type *analyseUnaryValue(Analyser *a, Context c, Node *n) {
   Type *curType;
   bool found;
 
-  switch (n->children.p[0].kind) {
+  switch (n->children.p[UNARY_OP].kind) {
   case N_DEREF:
     curType = a->types.tail;
     found = false;
@@ -865,7 +863,8 @@ Type *analyseUnaryValue(Analyser *a, Context c, Node *n) {
 
   case N_REF:
     if (c.expType->mod != TM_POINTER) {
-      throwAnalyserError(a, n->sourceName, n->children.p[0].line, FUNC_NAME,
+      throwAnalyserError(a, n->sourceName, n->children.p[UNARY_OP].line,
+                         FUNC_NAME,
                          "Expected type wasn't a pointer, but got one");
     }
     c.expType = c.expType->parent;
@@ -874,46 +873,46 @@ Type *analyseUnaryValue(Analyser *a, Context c, Node *n) {
     break;
   }
 
-  if (n->children.p[1].kind == N_UNARY_VALUE) {
-    type = analyseUnaryValue(a, c, n->children.p + 1);
+  if (n->children.p[UNARY_OPERAND].kind == N_UNARY_VALUE) {
+    type = analyseUnaryValue(a, c, n->children.p + UNARY_OPERAND);
   } else {
-    type = analyseExpression(a, c, n->children.p + 1);
+    type = analyseExpression(a, c, n->children.p + UNARY_OPERAND);
   }
 
-  switch (n->children.p[0].kind) {
+  switch (n->children.p[UNARY_OP].kind) {
   case N_INDEX:
     if (type->mod != TM_ARRAY) {
-      throwAnalyserError(a, n->sourceName, n->children.p[0].line, FUNC_NAME,
-                         "Can only index arrays");
+      throwAnalyserError(a, n->sourceName, n->children.p[UNARY_OP].line,
+                         FUNC_NAME, "Can only index arrays");
     }
     return type->parent;
   case N_DEREF:
     if (type->mod != TM_POINTER) {
-      throwAnalyserError(a, n->sourceName, n->children.p[0].line, FUNC_NAME,
-                         "Can only deref pointers");
+      throwAnalyserError(a, n->sourceName, n->children.p[UNARY_OP].line,
+                         FUNC_NAME, "Can only deref pointers");
     }
     if (type == a->preDefs.VOIDPTR) {
-      throwAnalyserError(a, n->sourceName, n->children.p[0].line, FUNC_NAME,
-                         "Can't deref void ptr (nil)");
+      throwAnalyserError(a, n->sourceName, n->children.p[UNARY_OP].line,
+                         FUNC_NAME, "Can't deref void ptr (nil)");
     }
     return type->parent;
   case N_DEC:
     if (type != a->preDefs.INT && type != a->preDefs.CHAR) {
-      throwAnalyserError(a, n->sourceName, n->children.p[0].line, FUNC_NAME,
-                         "Can only decrement ints or chars");
+      throwAnalyserError(a, n->sourceName, n->children.p[UNARY_OP].line,
+                         FUNC_NAME, "Can only decrement ints or chars");
     }
     return type;
   case N_INC:
     if (type != a->preDefs.INT && type != a->preDefs.CHAR) {
-      throwAnalyserError(a, n->sourceName, n->children.p[0].line, FUNC_NAME,
-                         "Can only increment ints or chars");
+      throwAnalyserError(a, n->sourceName, n->children.p[UNARY_OP].line,
+                         FUNC_NAME, "Can only increment ints or chars");
     }
     return type;
   case N_NOT:
     if (type != a->preDefs.INT && type != a->preDefs.CHAR &&
         type != a->preDefs.BOOL) {
-      throwAnalyserError(a, n->sourceName, n->children.p[0].line, FUNC_NAME,
-                         "Can only not int, char, bool, or float");
+      throwAnalyserError(a, n->sourceName, n->children.p[UNARY_OP].line,
+                         FUNC_NAME, "Can only not int, char, bool, or float");
     }
     return type;
   case N_REF:
@@ -934,19 +933,19 @@ Type *analyseUnaryValue(Analyser *a, Context c, Node *n) {
 
   case N_ADD:
     if (type != a->preDefs.INT && type != a->preDefs.CHAR) {
-      throwAnalyserError(a, n->sourceName, n->children.p[0].line, FUNC_NAME,
-                         "Can only positive int or char");
+      throwAnalyserError(a, n->sourceName, n->children.p[UNARY_OP].line,
+                         FUNC_NAME, "Can only positive int or char");
     }
     return type;
   case N_SUB:
     if (type != a->preDefs.INT && type != a->preDefs.CHAR) {
-      throwAnalyserError(a, n->sourceName, n->children.p[0].line, FUNC_NAME,
-                         "Can only negative int or char");
+      throwAnalyserError(a, n->sourceName, n->children.p[UNARY_OP].line,
+                         FUNC_NAME, "Can only negative int or char");
     }
     return type;
   default:
-    throwAnalyserError(a, n->sourceName, n->children.p[0].line, FUNC_NAME,
-                       "Unexpected unary");
+    throwAnalyserError(a, n->sourceName, n->children.p[UNARY_OP].line,
+                       FUNC_NAME, "Unexpected unary");
   }
   return NULL;
 }
@@ -956,10 +955,11 @@ Type *analyseFuncCall(Analyser *a, Context c, Node *n) {
 
   // printf("FuncCall %s\n", nodeCodeString(n->kind));
 
-  Fun *fun = funExists(a, n->children.p[1].data);
+  Node *nameNode = n->children.p + CALL_NAME;
+  Fun *fun = funExists(a, nameNode->data);
   if (fun == NULL) {
-    printf("Function name %s\n", n->children.p[1].data);
-    throwAnalyserError(a, n->sourceName, n->children.p[1].line, FUNC_NAME,
+    printf("Function name %s\n", nameNode->data);
+    throwAnalyserError(a, n->sourceName, nameNode->line, FUNC_NAME,
                        "Function doesn't exist");
   }
 
@@ -969,7 +969,7 @@ Type *analyseFuncCall(Analyser *a, Context c, Node *n) {
   }
 
   int paramIndex = 0;
-  int nodeIndex = 3;
+  int nodeIndex = CALL_ARGS;
 
   while (paramIndex < fun->paramsLen) {
     if (nodeIndex >= n->children.len) {
@@ -977,20 +977,15 @@ Type *analyseFuncCall(Analyser *a, Context c, Node *n) {
                          "Not enough args for function");
     }
 
-    if (n->children.p[nodeIndex].kind != N_EXPRESSION) {
-      throwAnalyserError(a, n->sourceName, n->children.p[nodeIndex].line,
-                         FUNC_NAME, "Not enough args for function");
-    }
-
     // Correct expected type
     c.expType = fun->params[paramIndex].type;
     analyseExpression(a, c, n->children.p + nodeIndex);
 
     ++paramIndex;
-    nodeIndex += 2;
+    ++nodeIndex;
   }
 
-  if (n->children.p[nodeIndex].kind == N_EXPRESSION) {
+  if (nodeIndex < n->children.len) {
     throwAnalyserError(a, n->sourceName, n->children.p[nodeIndex].line,
                        FUNC_NAME, "Too many args for function");
   }
@@ -1003,18 +998,19 @@ Type *analyseStructNew(Analyser *a, Context c, Node *n) {
 
   // printf("StructNew %s\n", nodeCodeString(n->kind));
 
-  Type *stt = typeExists(a, n->children.p[1].data);
+  Node *nameNode = n->children.p + CALL_NAME;
+  Type *stt = typeExists(a, nameNode->data);
   if (stt == NULL) {
-    throwAnalyserError(a, n->sourceName, n->children.p[1].line, FUNC_NAME,
+    throwAnalyserError(a, n->sourceName, nameNode->line, FUNC_NAME,
                        "Struct doesn't exist");
   }
   if (stt->propsLen == 0) {
-    throwAnalyserError(a, n->sourceName, n->children.p[1].line, FUNC_NAME,
+    throwAnalyserError(a, n->sourceName, nameNode->line, FUNC_NAME,
                        "Type used in struct new must be struct");
   }
 
   int propIndex = 0;
-  int nodeIndex = 3;
+  int nodeIndex = CALL_ARGS;
 
   while (propIndex < stt->propsLen) {
     if (nodeIndex >= n->children.len) {
@@ -1022,20 +1018,15 @@ Type *analyseStructNew(Analyser *a, Context c, Node *n) {
                          "Not enough args for struct");
     }
 
-    if (n->children.p[nodeIndex].kind != N_EXPRESSION) {
-      throwAnalyserError(a, n->sourceName, n->children.p[nodeIndex].line,
-                         FUNC_NAME, "Not enough args for struct");
-    }
-
     // Correct expected type
     c.expType = stt->props[propIndex].type;
     analyseExpression(a, c, n->children.p + nodeIndex);
 
     ++propIndex;
-    nodeIndex += 2;
+    ++nodeIndex;
   }
 
-  if (n->children.p[nodeIndex].kind == N_EXPRESSION) {
+  if (nodeIndex < n->children.len) {
     throwAnalyserError(a, n->sourceName, n->line, FUNC_NAME,
                        "Too many args for struct");
   }
@@ -1064,15 +1055,9 @@ Type *analyseMakeArray(Analyser *a, Context c, Node *n) {
     subType = expType->parent;
   }
 
-  int i = 2;
-
   Type *exprType = NULL;
 
-  while (i < n->children.len) {
-    if (n->children.p[i].kind != N_EXPRESSION) {
-      break;
-    }
-
+  for (int i = 0; i < n->children.len; ++i) {
     c.expType = subType;
 
     exprType = analyseExpression(a, c, n->children.p + i);
@@ -1083,8 +1068,6 @@ Type *analyseMakeArray(Analyser *a, Context c, Node *n) {
       throwAnalyserError(a, n->sourceName, n->children.p[i].line, FUNC_NAME,
                          "Expected correct typing for elements of new array");
     }
-
-    i += 2;
   }
 
   // We need to create the type if it doesn't exist
@@ -1129,10 +1112,10 @@ Type *analyseExpression(Analyser *a, Context c, Node *n) {
   if (n->children.len == 1) {
     // printf("Testing single element expression on line %i\n", n->line);
     // Unary or value?
-    if (n->children.p[0].kind == N_UNARY_VALUE) {
-      exprType = analyseUnaryValue(a, c, n->children.p);
+    if (n->children.p[EXPR_LEFT].kind == N_UNARY_VALUE) {
+      exprType = analyseUnaryValue(a, c, n->children.p + EXPR_LEFT);
     } else {
-      exprType = analyseValue(a, c, n->children.p);
+      exprType = analyseValue(a, c, n->children.p + EXPR_LEFT);
     }
 
     // Did we get the expected type?
@@ -1143,20 +1126,20 @@ Type *analyseExpression(Analyser *a, Context c, Node *n) {
     } else { // bad type
       printf("\nExpected type %s\n", typeString(c.expType));
       printf("Recieved type %s\n\n", typeString(exprType));
-      throwAnalyserError(a, n->sourceName, n->children.p[0].line, FUNC_NAME,
-                         "Expression did not have the correct type");
+      throwAnalyserError(a, n->sourceName, n->children.p[EXPR_LEFT].line,
+                         FUNC_NAME, "Expression did not have the correct type");
     }
   }
 
   // Unary or value?
-  if (n->children.p[0].kind == N_UNARY_VALUE) {
-    exprType = analyseUnaryValue(a, c, n->children.p);
+  if (n->children.p[EXPR_LEFT].kind == N_UNARY_VALUE) {
+    exprType = analyseUnaryValue(a, c, n->children.p + EXPR_LEFT);
   } else {
-    exprType = analyseValue(a, c, n->children.p);
+    exprType = analyseValue(a, c, n->children.p + EXPR_LEFT);
   }
 
   // Check all the values are the same
-  for (int i = 2; i < n->children.len; i += 2) {
+  for (int i = EXPR_RIGHT; i < n->children.len; i += EXPR_STEP) {
     if (n->children.p[i].kind == N_UNARY_VALUE) {
       if (!typeEqual(analyseUnaryValue(a, c, n->children.p + i), exprType)) {
         throwAnalyserError(a, n->sourceName, n->children.p[i].line, FUNC_NAME,
@@ -1171,7 +1154,7 @@ Type *analyseExpression(Analyser *a, Context c, Node *n) {
   }
 
   // Check the operators make sense
-  for (int i = 1; i < n->children.len - 1; i += 2) {
+  for (int i = EXPR_OP; i < n->children.len - 1; i += EXPR_STEP) {
     analyseOperator(a, c, n->children.p + i, exprType, exprType);
   }
 
@@ -1485,14 +1468,14 @@ Type *analyseComplexType(Analyser *a, Context c, Node *n) {
 
   TypeModifier mod = TM_NONE;
 
-  if (n->children.p[0].kind == N_INDEX) {
-    analyseIndex(a, c, n->children.p);
+  if (n->children.p[COMPLEX_TYPE_MOD].kind == N_INDEX) {
+    analyseIndex(a, c, n->children.p + COMPLEX_TYPE_MOD);
     mod = TM_ARRAY;
   } else {
     mod = TM_POINTER;
   }
 
-  Type *t = analyseComplexType(a, c, n->children.p + 1);
+  Type *t = analyseComplexType(a, c, n->children.p + COMPLEX_TYPE_INNER);
 
   Type *curType = a->types.tail;
 
@@ -1522,8 +1505,8 @@ void analyseBlock(Analyser *a, Context c, Node *n) {
 
   // printf("Block %s\n", nodeCodeString(n->kind));
 
-  for (int i = 1; i < n->children.len - 1; ++i) {
-    printf("Statement %s\n", nodeCodeString(n->children.p[i].kind));
+  for (int i = 0; i < n->children.len; ++i) {
+    LOG("Statement %s\n", nodeCodeString(n->children.p[i].kind));
     switch (n->children.p[i].kind) {
     case N_LONE_CALL:
       analyseLoneCall(a, c, n->children.p + i);
@@ -1568,4 +1551,5 @@ void analyse(Analyser *a) {
   identStackClear(&a->vars);
   funStackClear(&a->funs);
   typeStackClear(&a->types);
+  arenaDestroy(&a->arena);
 }
@@ -22,7 +22,9 @@ typedef struct Analyser {
   // Source
   Node inEnums, inStructs, inFuns;
 
-  // Defined variables, types, etc
+  // Defined variables, types, etc, all made in arena and gone once analysis
+  // is over
+  Arena arena;
   IdentStack vars;
   TypeStack types;
   FunStack funs;
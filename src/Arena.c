@@ -0,0 +1,87 @@
+#include "Arena.h"
+#include "Panic.h"
+#include "Stats.h"
+
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Big requests get a block to themselves
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+#define ARENA_ALIGN alignof(max_align_t)
+
+struct ArenaBlock {
+  ArenaBlock *prev;
+  size_t size;
+  size_t used;
+  alignas(max_align_t) char data[];
+};
+
+void arenaInit(Arena *a, Subsystem subsystem) {
+  a->block = NULL;
+  a->last = NULL;
+  a->subsystem = subsystem;
+}
+
+void *arenaAlloc(Arena *a, size_t size) {
+  if (a == NULL) {
+    panic("Allocating from an arena that isn't there");
+  }
+
+  size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+  if (a->block == NULL || a->block->size - a->block->used < size) {
+    size_t blockSize = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+
+    // calloc, so everything handed out is already zeroed
+    ArenaBlock *block = calloc(1, sizeof(ArenaBlock) + blockSize);
+    if (block == NULL) {
+      panic("Couldn't allocate arena block");
+    }
+    STAT_ALLOC(a->subsystem, sizeof(ArenaBlock) + blockSize)
+
+    block->prev = a->block;
+    block->size = blockSize;
+    block->used = 0;
+    a->block = block;
+  }
+
+  a->last = a->block->data + a->block->used;
+  a->block->used += size;
+  return a->last;
+}
+
+void *arenaGrow(Arena *a, void *p, size_t oldSize, size_t newSize) {
+  if (newSize <= oldSize) {
+    return p;
+  }
+
+  // The last allocation is at the end of the used part of the block, so it
+  // can take more of the block without moving
+  if (a != NULL && p != NULL && p == a->last) {
+    size_t start = (char *)p - a->block->data;
+    size_t end = (start + newSize + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    if (end <= a->block->size) {
+      a->block->used = end;
+      return p;
+    }
+  }
+
+  void *newP = arenaAlloc(a, newSize);
+  if (p != NULL && oldSize > 0) {
+    memcpy(newP, p, oldSize);
+  }
+  return newP;
+}
+
+void arenaDestroy(Arena *a) {
+  while (a->block != NULL) {
+    ArenaBlock *prev = a->block->prev;
+    STAT_FREE(a->subsystem, sizeof(ArenaBlock) + a->block->size)
+    free(a->block);
+    a->block = prev;
+  }
+
+  a->last = NULL;
+}
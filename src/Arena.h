@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Stats.h"
+
+#include <stddef.h>
+
+// Hands out memory by bumping a pointer through large blocks, and frees all of
+// it at once. Nothing from an arena is freed on its own, so it suits things
+// that all go at the same time, like a file's parse tree or a phase's
+// scratch. Memory from an arena always starts zeroed
+
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct Arena {
+  ArenaBlock *block; // The newest, the only one with room left
+  void *last;        // The most recent allocation, which can grow in place
+  Subsystem subsystem;
+} Arena;
+
+#define ZERO_ARENA (Arena){NULL, NULL, SUB_NODES}
+
+// The blocks are counted under subsystem in --stats
+void arenaInit(Arena *a, Subsystem subsystem);
+
+void *arenaAlloc(Arena *a, size_t size);
+
+// Gives p, an allocation of oldSize, room for newSize. Grows in place if p was
+// the last thing allocated, otherwise copies it somewhere new. p can be NULL,
+// or come from a different arena
+void *arenaGrow(Arena *a, void *p, size_t oldSize, size_t newSize);
+
+// Frees every block, the arena can be used again afterwards
+void arenaDestroy(Arena *a);
@@ -0,0 +1,408 @@
+#include "AstCache.h"
+#include "Compile.h"
+#include "Panic.h"
+#include "Stats.h"
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Bumped whenever the layout of a cached tree changes
+#define AST_CACHE_FORMAT 2
+
+#define AST_CACHE_MAGIC "NAVAST"
+#define AST_CACHE_MAGIC_LEN 6
+
+#define PATH_SIZE 1024
+
+// Any rebuild could change what the parser makes, so the build time counts as
+// part of the version
+const char *compilerVersion = NAV_VERSION " " __DATE__ " " __TIME__;
+
+// Keeps temporary file names apart between threads
+atomic_int tempFileCount;
+
+errno_t astCacheInit(char *dir) {
+#ifdef _WIN32
+  if (_mkdir(dir) && errno != EEXIST) {
+#else
+  if (mkdir(dir, 0777) && errno != EEXIST) {
+#endif
+    return 1;
+  }
+
+  return 0;
+}
+
+errno_t astCacheKey(char *fileName, unsigned long long *key) {
+  if (hashFile(fileName, key)) {
+    return 1;
+  }
+
+  // Carry on the file's hash, as if the version came after its contents
+  for (const char *c = compilerVersion; *c; ++c) {
+    *key = (*key ^ (unsigned char)*c) * 1099511628211ULL;
+  }
+  *key = (*key ^ AST_CACHE_FORMAT) * 1099511628211ULL;
+
+  return 0;
+}
+
+// Fails rather than giving a cut short path when dir is too long
+errno_t cachePath(char *dest, char *dir, unsigned long long key) {
+  int len = snprintf(dest, PATH_SIZE, "%s/%016llx.ast", dir, key);
+  return len < 0 || len >= PATH_SIZE;
+}
+
+// Writing
+
+// Gives each distinct string an index, interned strings are the same string
+// exactly when they're the same pointer, so pointers are all that's hashed
+typedef struct StringTable {
+  char **strings; // In the order they were first seen
+  int count;
+  int cap;
+
+  char **slots; // Open addressing, always at most half full
+  int *indexes;
+  int slotCount;
+} StringTable;
+
+unsigned int pointerHash(char *str) {
+  unsigned long long h = (unsigned long long)(size_t)str;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return (unsigned int)h;
+}
+
+errno_t stringTableGrow(StringTable *t) {
+  int slotCount = t->slotCount ? t->slotCount * 2 : 256;
+  char **slots = calloc(slotCount, sizeof(char *));
+  int *indexes = malloc(slotCount * sizeof(int));
+  char **strings = realloc(t->strings, slotCount / 2 * sizeof(char *));
+  if (slots == NULL || indexes == NULL || strings == NULL) {
+    free(slots);
+    free(indexes);
+    if (strings != NULL) {
+      t->strings = strings;
+    }
+    return 1;
+  }
+
+  for (int i = 0; i < t->slotCount; ++i) {
+    if (t->slots[i] == NULL) {
+      continue;
+    }
+
+    unsigned int j = pointerHash(t->slots[i]) & (slotCount - 1);
+    while (slots[j] != NULL) {
+      j = (j + 1) & (slotCount - 1);
+    }
+    slots[j] = t->slots[i];
+    indexes[j] = t->indexes[i];
+  }
+
+  free(t->slots);
+  free(t->indexes);
+  t->slots = slots;
+  t->indexes = indexes;
+  t->slotCount = slotCount;
+  t->strings = strings;
+  t->cap = slotCount / 2;
+  return 0;
+}
+
+// Returns the string's index, adding it if it's new, or -1 if out of memory
+int stringTableIndex(StringTable *t, char *str) {
+  if (t->count == t->cap && stringTableGrow(t)) {
+    return -1;
+  }
+
+  unsigned int i = pointerHash(str) & (t->slotCount - 1);
+  while (t->slots[i] != NULL) {
+    if (t->slots[i] == str) {
+      return t->indexes[i];
+    }
+    i = (i + 1) & (t->slotCount - 1);
+  }
+
+  t->slots[i] = str;
+  t->indexes[i] = t->count;
+  t->strings[t->count] = str;
+  return t->count++;
+}
+
+void stringTableDestroy(StringTable *t) {
+  free(t->strings);
+  free(t->slots);
+  free(t->indexes);
+}
+
+errno_t collectStrings(StringTable *t, Node *n) {
+  if (n->data != NULL && stringTableIndex(t, n->data) < 0) {
+    return 1;
+  }
+
+  for (int i = 0; i < n->children.len; ++i) {
+    if (collectStrings(t, n->children.p + i)) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+void writeVarint(FILE *f, unsigned long long n) {
+  while (n >= 0x80) {
+    fputc((int)(n & 0x7f) | 0x80, f);
+    n >>= 7;
+  }
+  fputc((int)n, f);
+}
+
+void writeNode(FILE *f, StringTable *t, Node *n) {
+  writeVarint(f, n->kind);
+  writeVarint(f, n->line);
+
+  // 0 is no data, so indexes are off by one
+  writeVarint(f, n->data == NULL ? 0 : stringTableIndex(t, n->data) + 1);
+
+  writeVarint(f, n->children.len);
+  for (int i = 0; i < n->children.len; ++i) {
+    writeNode(f, t, n->children.p + i);
+  }
+}
+
+errno_t astCacheStore(char *dir, unsigned long long key, Node *tree) {
+  // Written under a name only this thread uses, then renamed into place, so
+  // a compile running at the same time never sees half a file
+  char path[PATH_SIZE], tempPath[PATH_SIZE];
+  if (cachePath(path, dir, key)) {
+    return 1;
+  }
+
+  int len = snprintf(tempPath, PATH_SIZE, "%s.%i.%i.tmp", path, (int)getpid(),
+                     atomic_fetch_add(&tempFileCount, 1));
+  if (len < 0 || len >= PATH_SIZE) {
+    return 1;
+  }
+
+  StringTable t = {0};
+  if (collectStrings(&t, tree)) {
+    stringTableDestroy(&t);
+    return 1;
+  }
+
+  FILE *f;
+  if (fopen_s(&f, tempPath, "wb")) {
+    stringTableDestroy(&t);
+    return 1;
+  }
+
+  fwrite(AST_CACHE_MAGIC, 1, AST_CACHE_MAGIC_LEN, f);
+  writeVarint(f, key);
+
+  writeVarint(f, t.count);
+  for (int i = 0; i < t.count; ++i) {
+    size_t len = strlen(t.strings[i]);
+    writeVarint(f, len);
+    fwrite(t.strings[i], 1, len, f);
+  }
+
+  writeNode(f, &t, tree);
+  stringTableDestroy(&t);
+
+  if (ferror(f) | fclose(f)) {
+    remove(tempPath);
+    return 1;
+  }
+
+#ifdef _WIN32
+  // Windows won't rename over a file, one that's there has the same tree
+  remove(path);
+#endif
+  if (rename(tempPath, path)) {
+    remove(tempPath);
+    return 1;
+  }
+
+  return 0;
+}
+
+// Reading
+
+typedef struct CacheReader {
+  const unsigned char *at;
+  const unsigned char *end;
+  char **strings; // Already interned
+  unsigned long long stringCount;
+  bool bad;
+} CacheReader;
+
+unsigned long long readVarint(CacheReader *r) {
+  unsigned long long n = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (r->at == r->end) {
+      break;
+    }
+
+    unsigned char b = *r->at++;
+    n |= (unsigned long long)(b & 0x7f) << shift;
+    if (!(b & 0x80)) {
+      return n;
+    }
+  }
+
+  r->bad = true;
+  return 0;
+}
+
+// Every count is checked against what's left of the file, so a corrupt file
+// can't make the reader allocate or read past the end
+Node readNode(CacheReader *r, char *sourceName) {
+  unsigned long long kind = readVarint(r);
+  unsigned long long line = readVarint(r);
+  unsigned long long data = readVarint(r);
+  unsigned long long childCount = readVarint(r);
+
+  if (r->bad || kind > N_STRING || line > 0x7fffffff ||
+      data > r->stringCount || childCount > (size_t)(r->end - r->at)) {
+    r->bad = true;
+    return ZERO_NODE;
+  }
+
+  Node n = {kind, ZERO_LIST, data ? r->strings[data - 1] : NULL, (int)line,
+            sourceName};
+
+  if (NodeListInit(&n.children, (int)childCount)) {
+    panic("Couldn't create node (failed to init list)");
+  }
+  STAT_NODE(n.kind)
+
+  for (unsigned long long i = 0; i < childCount && !r->bad; ++i) {
+    NodeListAppend(&n.children, readNode(r, sourceName));
+  }
+
+  return n;
+}
+
+errno_t readTree(CacheReader *r, unsigned long long key, Node *tree,
+                 char *sourceName, StringManager *sm) {
+  if (r->end - r->at < AST_CACHE_MAGIC_LEN ||
+      memcmp(r->at, AST_CACHE_MAGIC, AST_CACHE_MAGIC_LEN)) {
+    return 1;
+  }
+  r->at += AST_CACHE_MAGIC_LEN;
+
+  // Guards against two keys landing on the same file name
+  if (readVarint(r) != key) {
+    return 1;
+  }
+
+  r->stringCount = readVarint(r);
+  if (r->bad || r->stringCount > (size_t)(r->end - r->at)) {
+    return 1;
+  }
+
+  r->strings = malloc((r->stringCount + 1) * sizeof(char *));
+  if (r->strings == NULL) {
+    return 1;
+  }
+
+  for (unsigned long long i = 0; i < r->stringCount; ++i) {
+    unsigned long long len = readVarint(r);
+    if (r->bad || len > (size_t)(r->end - r->at)) {
+      free(r->strings);
+      return 1;
+    }
+
+    r->strings[i] = getSymbol(sm, (const char *)r->at, (int)len).str;
+    r->at += len;
+  }
+
+  *tree = readNode(r, sourceName);
+  free(r->strings);
+
+  // The caller throws away the arena the nodes were made in
+  if (r->bad || tree->kind != N_PROGRAM || r->at != r->end) {
+    return 1;
+  }
+
+  return 0;
+}
+
+errno_t astCacheLoad(char *dir, unsigned long long key, Node *tree,
+                     char *sourceName, StringManager *sm) {
+  char path[PATH_SIZE];
+  if (cachePath(path, dir, key)) {
+    return 1;
+  }
+
+  CacheReader r = {0};
+  errno_t err;
+
+#ifdef _WIN32
+  FILE *f;
+  if (fopen_s(&f, path, "rb")) {
+    return 1;
+  }
+
+  fseek(f, 0, SEEK_END);
+  long len = ftell(f);
+  fseek(f, 0, SEEK_SET);
+
+  unsigned char *data = malloc(len > 0 ? len : 1);
+  if (data == NULL || fread(data, 1, len, f) != (size_t)len) {
+    free(data);
+    fclose(f);
+    return 1;
+  }
+  fclose(f);
+
+  r.at = data;
+  r.end = data + len;
+  err = readTree(&r, key, tree, sourceName, sm);
+  free(data);
+#else
+  // Mapped rather than read, the strings are copied out as they're interned
+  // and nothing else needs the file once the tree's built
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return 1;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) || st.st_size == 0) {
+    close(fd);
+    return 1;
+  }
+
+  void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return 1;
+  }
+
+  r.at = data;
+  r.end = r.at + st.st_size;
+  err = readTree(&r, key, tree, sourceName, sm);
+  munmap(data, st.st_size);
+#endif
+
+  return err;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Node.h"
+#include "StringManager.h"
+
+#include <corecrt.h>
+
+// Parsing only depends on a file's contents and the compiler, so parse trees
+// are saved to a directory keyed on a hash of both, and loaded back instead
+// of parsing when neither has changed.
+//
+// A cached tree is its strings, each written once, followed by its nodes in
+// pre-order. Every number is a variable length integer, 7 bits to a byte
+
+// Makes the cache directory if it isn't there already
+errno_t astCacheInit(char *dir);
+
+// Hashes the file's contents along with the compiler's version
+errno_t astCacheKey(char *fileName, unsigned long long *key);
+
+// Loads the tree saved under key into nodeArena, interning its strings into
+// sm. Returns non-zero if there isn't one or it can't be read, then the file
+// needs parsing and whatever was put in the arena is garbage
+errno_t astCacheLoad(char *dir, unsigned long long key, Node *tree,
+                     char *sourceName, StringManager *sm);
+
+// Saves a freshly parsed tree under key, failing only means it'll be parsed
+// again next time
+errno_t astCacheStore(char *dir, unsigned long long key, Node *tree);
@@ -1,3 +1,3 @@
 #include "list.h"
 
-NEW_LIST_TYPE(char, Char)
+NEW_LIST_TYPE(char, Char, SUB_CHARS)
@@ -0,0 +1,497 @@
+#include "Compile.h"
+#include "Analyser.h"
+#include "AstCache.h"
+#include "Emitter.h"
+#include "Hoister.h"
+#include "Lexer.h"
+#include "Optimiser.h"
+#include "Panic.h"
+#include "Stats.h"
+#include "Trace.h"
+
+#include <setjmp.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#define dup _dup
+#define dup2 _dup2
+#define fdopen _fdopen
+#define fileno _fileno
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+// Counts the outputs written by this process, so that two compiles writing the
+// same output never share a temporary file
+atomic_int tempOutCount;
+
+// Hands standard output over to the emitted C, everything printed from then
+// on goes to stderr so it doesn't end up in the middle of the C
+FILE *takeStdout(void) {
+  fflush(stdout);
+
+  int fd = dup(fileno(stdout));
+  if (fd < 0 || dup2(fileno(stderr), fileno(stdout)) < 0) {
+    return NULL;
+  }
+
+  return fdopen(fd, "w");
+}
+
+errno_t readOptions(Options *o, int argc, char *argv[]) {
+  o->fileCount = 0;
+  o->jobs = 1;
+  o->reportFormat = REPORT_NONE;
+  o->traceName = NULL;
+  o->cacheDir = NULL;
+  o->outName = "../output/main.c";
+  o->outStream = NULL;
+  o->optimising = true;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-j")) {
+      if (i + 1 == argc || (o->jobs = atoi(argv[i + 1])) < 1) {
+        printf("-j expects a number of threads greater than 0\n");
+        return 1;
+      }
+      ++i;
+      continue;
+    }
+
+    if (!strcmp(argv[i], "--trace")) {
+      if (i + 1 == argc) {
+        printf("--trace expects a file to write the trace to\n");
+        return 1;
+      }
+      o->traceName = argv[i + 1];
+      ++i;
+      continue;
+    }
+
+    if (!strcmp(argv[i], "-o")) {
+      if (i + 1 == argc) {
+        printf("-o expects a file to write the C to, or - for standard "
+               "output\n");
+        return 1;
+      }
+      o->outName = argv[i + 1];
+      ++i;
+      continue;
+    }
+
+    if (!strcmp(argv[i], "--cache")) {
+      if (i + 1 == argc) {
+        printf("--cache expects a directory to keep parsed files in\n");
+        return 1;
+      }
+      o->cacheDir = argv[i + 1];
+      ++i;
+      continue;
+    }
+
+    if (!strcmp(argv[i], "--time-report")) {
+      o->reportFormat = REPORT_TABLE;
+      continue;
+    }
+
+    if (!strcmp(argv[i], "--time-report=json")) {
+      o->reportFormat = REPORT_JSON;
+      continue;
+    }
+
+    // Mostly for comparing against the optimised output
+    if (!strcmp(argv[i], "--no-optimise")) {
+      o->optimising = false;
+      continue;
+    }
+
+    // Before anything is allocated, so everything gets counted
+    if (!strcmp(argv[i], "--stats")) {
+      statsEnabled = true;
+      continue;
+    }
+
+    o->fileNames[o->fileCount] = argv[i];
+    ++o->fileCount;
+  }
+
+  if (!strcmp(o->outName, "-") && (o->outStream = takeStdout()) == NULL) {
+    printf("Couldn't write the C to standard output\n");
+    return 1;
+  }
+
+  return 0;
+}
+
+bool validFileName(char fileName[]) {
+  int i = 0;
+  int dotIndex = -1;
+  while (fileName[i]) {
+    if (fileName[i] == '.') {
+      dotIndex = i;
+    }
+    ++i;
+  }
+
+  // No file extension
+  if (dotIndex == -1) {
+    return false;
+  }
+
+  // Correct file extension length
+  if (i - dotIndex != 4) {
+    return false;
+  }
+
+  // Check extension
+  if (fileName[dotIndex + 1] != 'n') {
+    return false;
+  }
+
+  if (fileName[dotIndex + 2] != 'a') {
+    return false;
+  }
+
+  if (fileName[dotIndex + 3] != 'v') {
+    return false;
+  }
+
+  // It's good
+  return true;
+}
+
+errno_t validateFiles(Options *o) {
+  printf("Validating files\n");
+  for (int i = 0; i < o->fileCount; ++i) {
+    if (!validFileName(o->fileNames[i])) {
+      printf("Filename %s had incorrect file extension.\n", o->fileNames[i]);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+// Files are independent until hoisting, so each one can be lexed and parsed on
+// its own thread
+typedef struct FrontEnd {
+  char **fileNames;
+  int fileCount;
+  Lexer *lexers;
+  Parser *parsers;
+  StringManager *sm;
+  TimeReport *report;
+  bool recover;
+  char *cacheDir;
+
+  // The next file that hasn't been picked up by a worker
+  atomic_int next;
+
+  // Only set when recovering
+  atomic_bool failed;
+} FrontEnd;
+
+// Lexes and parses files until there are none left, any number of threads can
+// run this at once
+int frontEndWorker(void *arg) {
+  FrontEnd *fe = arg;
+  jmp_buf recovery;
+  int i;
+
+  while ((i = atomic_fetch_add(&fe->next, 1)) < fe->fileCount) {
+    Stopwatch sw = startStopwatch(fe->report, true);
+
+    // Everything in the file's tree comes from its own arena, so the tree can
+    // be let go of in one step whenever it's done with
+    arenaInit(&fe->parsers[i].arena, SUB_NODES);
+    nodeArena = &fe->parsers[i].arena;
+
+    // A file that can't be hashed is left for the lexer to complain about
+    unsigned long long key;
+    bool keyed =
+        fe->cacheDir != NULL && !astCacheKey(fe->fileNames[i], &key);
+    if (keyed) {
+      TRACE_BEGIN("cache-load", fe->fileNames[i]);
+      errno_t missed = astCacheLoad(fe->cacheDir, key, &fe->parsers[i].out,
+                                    fe->fileNames[i], fe->sm);
+      TRACE_END("cache-load", fe->fileNames[i]);
+
+      if (!missed) {
+        printf("Loaded %s from the cache\n", fe->fileNames[i]);
+        fe->parsers[i].sourceName = fe->fileNames[i];
+        STAT_COUNT(COUNT_CACHE_HITS, 1)
+        endFilePhase(fe->report, sw, "Lexing and parsing", i,
+                     fe->fileNames[i]);
+        continue;
+      }
+      STAT_COUNT(COUNT_CACHE_MISSES, 1)
+
+      // Whatever was read before it went wrong
+      arenaDestroy(&fe->parsers[i].arena);
+    }
+
+    // The parser pulls tokens from the lexer as it goes
+    printf("Parsing %s\n", fe->fileNames[i]);
+    TRACE_BEGIN("parse", fe->fileNames[i]);
+    if (lexerInit(&fe->lexers[i], fe->fileNames[i], fe->sm)) {
+      printf("Couldn't open file %s\n", fe->fileNames[i]);
+      if (!fe->recover) {
+        exit(1);
+      }
+      atomic_store(&fe->failed, true);
+      continue;
+    }
+
+    if (fe->recover) {
+      if (setjmp(recovery)) {
+        // The error's been printed, throw away whatever was parsed so far
+        errorRecovery = NULL;
+        lexerDestroy(&fe->lexers[i]);
+        arenaDestroy(&fe->parsers[i].arena);
+        atomic_store(&fe->failed, true);
+        continue;
+      }
+      errorRecovery = &recovery;
+    }
+
+    parserInit(&fe->parsers[i], fe->fileNames[i], &fe->lexers[i], fe->sm);
+    parse(&fe->parsers[i]);
+    errorRecovery = NULL;
+
+    // char *out = nodeString(&fe->parsers[i].out);
+    // printf("%s\n", out);
+    // free(out);
+
+    // Free the source before moving on
+    lexerDestroy(&fe->lexers[i]);
+    TRACE_END("parse", fe->fileNames[i]);
+
+    if (keyed && astCacheStore(fe->cacheDir, key, &fe->parsers[i].out)) {
+      printf("Couldn't save %s to the cache\n", fe->fileNames[i]);
+    }
+    endFilePhase(fe->report, sw, "Lexing and parsing", i, fe->fileNames[i]);
+  }
+
+  nodeArena = NULL;
+  return 0;
+}
+
+errno_t frontEnd(char **fileNames, int fileCount, Parser parsers[], int jobs,
+                 StringManager *sm, TimeReport *report, bool recover,
+                 char *cacheDir) {
+  if (cacheDir != NULL && astCacheInit(cacheDir)) {
+    printf("Couldn't make the cache directory %s, carrying on without it\n",
+           cacheDir);
+    cacheDir = NULL;
+  }
+
+  Lexer lexers[fileCount > 0 ? fileCount : 1];
+
+  FrontEnd fe = {fileNames, fileCount, lexers,  parsers,
+                 sm,        report,    recover, cacheDir};
+  atomic_init(&fe.next, 0);
+  atomic_init(&fe.failed, false);
+
+  // No point having more threads than files
+  if (jobs > fileCount) {
+    jobs = fileCount > 0 ? fileCount : 1;
+  }
+
+  // This thread works too, so only jobs - 1 extra are needed
+  thrd_t workers[jobs];
+  for (int i = 1; i < jobs; ++i) {
+    if (thrd_create(&workers[i], frontEndWorker, &fe) != thrd_success) {
+      printf("Couldn't start worker thread\n");
+      exit(1);
+    }
+  }
+
+  frontEndWorker(&fe);
+
+  for (int i = 1; i < jobs; ++i) {
+    thrd_join(workers[i], NULL);
+  }
+
+  return atomic_load(&fe.failed);
+}
+
+// Whether two files hold exactly the same bytes, so the output can be left
+// alone and whatever builds it doesn't see it change
+bool sameFiles(char *aName, char *bName) {
+  FILE *a, *b;
+  if (fopen_s(&a, aName, "rb")) {
+    return false;
+  }
+  if (fopen_s(&b, bName, "rb")) {
+    fclose(a);
+    return false;
+  }
+
+  char aBuf[4096], bBuf[4096];
+  size_t aLen, bLen;
+  bool same = true;
+  do {
+    aLen = fread(aBuf, 1, sizeof(aBuf), a);
+    bLen = fread(bBuf, 1, sizeof(bBuf), b);
+    same = aLen == bLen && !memcmp(aBuf, bBuf, aLen);
+  } while (same && aLen > 0);
+
+  fclose(a);
+  fclose(b);
+  return same;
+}
+
+void backEnd(Parser parsers[], int fileCount, Options *options,
+             StringManager *sm, TimeReport *report) {
+  // Nodes and child lists the back end makes or grows, the files' trees are
+  // left in their own arenas
+  Arena arena;
+  arenaInit(&arena, SUB_NODES);
+  nodeArena = &arena;
+
+  // Hoist from each file into one place, in the order the files were given
+  printf("Hoisting\n");
+  Stopwatch sw = startStopwatch(report, false);
+  TRACE_BEGIN("phase", "Hoisting");
+  Hoister h;
+  hoist(&h, parsers, fileCount);
+  TRACE_END("phase", "Hoisting");
+  endPhase(report, sw, "Hoisting");
+  printf("End hoisting\n\n");
+
+  char *out;
+  //
+  // out = nodeString(&h.enums);
+  // printf("Enums\n%s\n", out);
+  // free(out);
+  //
+  // out = nodeString(&h.structs);
+  // printf("Structs\n%s\n", out);
+  // free(out);
+  //
+  // out = nodeString(&h.funcs);
+  // printf("Funcs\n%s\n", out);
+  // free(out);
+
+  // Semantic Analysis
+  printf("Analysing\n");
+  sw = startStopwatch(report, false);
+  TRACE_BEGIN("phase", "Analysing");
+  Analyser a;
+  analyserInit(&a, h.enums, h.structs, h.funcs, sm);
+  analyse(&a);
+  TRACE_END("phase", "Analysing");
+  endPhase(report, sw, "Analysing");
+  printf("End anlysis\n\n");
+
+  // Optimise
+  if (options->optimising) {
+    printf("Optimising\n");
+    sw = startStopwatch(report, false);
+    TRACE_BEGIN("phase", "Optimising");
+    Optimiser o;
+    optimiserInit(&o, a.inFuns, sm);
+    printf("Optimiser init\n");
+    optimise(&o);
+    TRACE_END("phase", "Optimising");
+    endPhase(report, sw, "Optimising");
+    printf("End optimisation\n\n");
+  }
+
+  // Emit to C, straight into the output. A file is written under another name
+  // first, so it's never left half written and can be left alone if nothing
+  // changed
+  FILE *dest = options->outStream;
+  char tempName[1024];
+  if (dest == NULL) {
+    int len = snprintf(tempName, sizeof(tempName), "%s.%i.%i.tmp",
+                       options->outName, (int)getpid(),
+                       atomic_fetch_add(&tempOutCount, 1));
+    if (len < 0 || len >= (int)sizeof(tempName)) {
+      printf("Output path %s is too long\n", options->outName);
+      exit(1);
+    }
+
+    if (fopen_s(&dest, tempName, "w")) {
+      printf("Couldn't open %s\n", tempName);
+      exit(1);
+    }
+  }
+
+  printf("Emitting\n");
+  sw = startStopwatch(report, false);
+  TRACE_BEGIN("phase", "Emitting");
+  Emitter e;
+  emitterInit(&e, a.inEnums, a.inStructs, a.inFuns, sm);
+  printf("Emitter initialised\n");
+  errno_t failed = emit(&e, dest);
+  if (dest == options->outStream) {
+    failed |= fflush(dest) != 0;
+  } else {
+    failed |= fclose(dest) != 0;
+  }
+  TRACE_END("phase", "Emitting");
+  endPhase(report, sw, "Emitting");
+
+  if (failed) {
+    printf("Couldn't write the output\n");
+    if (dest != options->outStream) {
+      remove(tempName);
+    }
+    exit(1);
+  }
+  printf("End emitting\n\n");
+
+  printf("Saving to file\n");
+  sw = startStopwatch(report, false);
+  TRACE_BEGIN("phase", "Saving");
+  if (options->outStream != NULL) {
+    // Already written
+  } else if (sameFiles(tempName, options->outName)) {
+    remove(tempName);
+    printf("Output unchanged, leaving it alone\n");
+  } else {
+#ifdef _WIN32
+    // Windows won't rename over a file
+    remove(options->outName);
+#endif
+    if (rename(tempName, options->outName)) {
+      printf("Couldn't save to %s\n", options->outName);
+      remove(tempName);
+      exit(1);
+    }
+  }
+  TRACE_END("phase", "Saving");
+  endPhase(report, sw, "Saving");
+  printf("Saved\n\n");
+
+  nodeArena = NULL;
+  arenaDestroy(&arena);
+}
+
+errno_t hashFile(char *fileName, unsigned long long *hash) {
+  FILE *f;
+  if (fopen_s(&f, fileName, "rb")) {
+    return 1;
+  }
+
+  unsigned long long h = 14695981039346656037ULL;
+  unsigned char buf[4096];
+  size_t len;
+  while ((len = fread(buf, 1, sizeof(buf), f)) > 0) {
+    for (size_t i = 0; i < len; ++i) {
+      h = (h ^ buf[i]) * 1099511628211ULL;
+    }
+  }
+
+  fclose(f);
+  *hash = h;
+  return 0;
+}
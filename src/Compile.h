@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Parser.h"
+#include "StringManager.h"
+#include "TimeReport.h"
+
+#include <corecrt.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define NAV_VERSION "0.1"
+
+// How a compile was asked for on the command line
+typedef struct Options {
+  char **fileNames; // Needs room for every argument
+  int fileCount;
+  int jobs;
+  ReportFormat reportFormat;
+  char *traceName;
+  char *cacheDir;  // NULL when the AST cache is off
+  char *outName;   // Where the C goes, - for standard output
+  FILE *outStream; // Standard output when that's where the C goes
+  bool optimising;
+} Options;
+
+// Reads the options and files out of the arguments, prints what's wrong and
+// returns non-zero if they don't make sense
+errno_t readOptions(Options *o, int argc, char *argv[]);
+
+// Checks the file has a .nav extension
+bool validFileName(char fileName[]);
+
+// Checks every file in o, printing the first that's wrong
+errno_t validateFiles(Options *o);
+
+// Lexes and parses each file, spread over jobs threads. If recover is set an
+// error in one file doesn't exit, the rest still get parsed and this returns
+// non-zero once they're done. Files already in cacheDir are loaded from there
+// instead, unless it's NULL
+errno_t frontEnd(char **fileNames, int fileCount, Parser parsers[], int jobs,
+                 StringManager *sm, TimeReport *report, bool recover,
+                 char *cacheDir);
+
+// Everything from hoisting the parsed files to saving the C
+void backEnd(Parser parsers[], int fileCount, Options *options,
+             StringManager *sm, TimeReport *report);
+
+// Hashes a file's contents with 64 bit FNV-1a, so a changed file can be told
+// apart from one that's only been saved again
+errno_t hashFile(char *fileName, unsigned long long *hash);
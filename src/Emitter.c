@@ -1,13 +1,68 @@
 #include "Emitter.h"
 #include "Node.h"
 #include "Panic.h"
+#include "Stats.h"
 #include "StringManager.h"
+#include "Trace.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define PUSH_CHAR(character)                                                   \
-  if (CharListAppend(out, (character)))                                        \
-    panic("Couldn't append to output");
+  {                                                                            \
+    if (out->len == EMIT_BUFFER_SIZE) {                                        \
+      flushEmitBuffer(out);                                                    \
+    }                                                                          \
+    out->p[out->len] = (character);                                            \
+    ++out->len;                                                                \
+  }
+
+// Writes out what's been emitted so far and empties the buffer, a failed
+// write is remembered and reported once emitting's done
+void flushEmitBuffer(EmitBuffer *out) {
+  if (!out->failed &&
+      fwrite(out->p, 1, out->len, out->dest) != (size_t)out->len) {
+    out->failed = true;
+  }
+  out->len = 0;
+}
+
+// Appends len characters from str to the output, copying as much at a time
+// as fits in the buffer
+void pushSlice(EmitBuffer *out, const char *str, int len) {
+  // The usual case, all of it fits
+  if (len <= EMIT_BUFFER_SIZE - out->len) {
+    memcpy(out->p + out->len, str, len);
+    out->len += len;
+    return;
+  }
+
+  while (len > 0) {
+    if (out->len == EMIT_BUFFER_SIZE) {
+      flushEmitBuffer(out);
+    }
+
+    int n = EMIT_BUFFER_SIZE - out->len;
+    if (n > len) {
+      n = len;
+    }
+
+    memcpy(out->p + out->len, str, n);
+    out->len += n;
+    str += n;
+    len -= n;
+  }
+}
+
+// Appends an interned string, its length is already known
+void pushSymbol(EmitBuffer *out, char *str) {
+  pushSlice(out, str, symbolLen(str));
+}
+
+// Appends a string literal, sizeof gives its length without looking for the
+// end of it
+#define PUSH_STR(literal) pushSlice(out, "" literal, sizeof(literal) - 1);
 
 void emitterInit(Emitter *e, Node enums, Node structs, Node funs,
                  StringManager *sm) {
@@ -21,108 +76,67 @@ void emitterInit(Emitter *e, Node enums, Node structs, Node funs,
   e->sm = sm;
 }
 
-void emitTabs(Emitter *e, CharList *out) {
+void emitTabs(Emitter *e, EmitBuffer *out) {
   for (int i = 0; i < e->tabs; ++i) {
-    PUSH_CHAR(' ')
-    PUSH_CHAR(' ')
+    PUSH_STR("  ")
   }
 }
 
-void emitBlock(Emitter *e, CharList *out, Node n);
-void emitExpression(Emitter *e, CharList *out, Node n);
-void emitAccess(Emitter *e, CharList *out, Node n);
-void emitFuncCall(Emitter *e, CharList *out, Node n);
-void emitSwitchState(Emitter *e, CharList *out, Node n);
+void emitBlock(Emitter *e, EmitBuffer *out, Node n);
+void emitExpression(Emitter *e, EmitBuffer *out, Node n);
+void emitAccess(Emitter *e, EmitBuffer *out, Node n);
+void emitFuncCall(Emitter *e, EmitBuffer *out, Node n);
+void emitSwitchState(Emitter *e, EmitBuffer *out, Node n);
+void emitUnaryValue(Emitter *e, EmitBuffer *out, Node n);
+void emitIndex(Emitter *e, EmitBuffer *out, Node n);
 
-void emitEnum(Emitter *e, CharList *out, Node n) {
-  char *enumName = n.children.p[1].data;
+void emitEnum(Emitter *e, EmitBuffer *out, Node n) {
+  char *enumName = n.children.p[DEF_NAME].data;
 
   // typedef
-  PUSH_CHAR('t')
-  PUSH_CHAR('y')
-  PUSH_CHAR('p')
-  PUSH_CHAR('e')
-  PUSH_CHAR('d')
-  PUSH_CHAR('e')
-  PUSH_CHAR('f')
-  PUSH_CHAR(' ')
+  PUSH_STR("typedef ")
 
   // typedef enum
-  PUSH_CHAR('e')
-  PUSH_CHAR('n')
-  PUSH_CHAR('u')
-  PUSH_CHAR('m')
-  PUSH_CHAR(' ')
+  PUSH_STR("enum ")
 
   // typedef enum Test
-  int i = 0;
-  while (enumName[i]) {
-    PUSH_CHAR(enumName[i])
-    ++i;
-  }
+  pushSymbol(out, enumName);
   PUSH_CHAR(' ')
 
   // typedef enum Test {
   PUSH_CHAR('{')
 
-  for (int i = 3; i < n.children.len - 1; ++i) {
-    Node node = n.children.p[i];
-
-    if (node.kind == N_SEP) {
-      PUSH_CHAR(',')
-    } else if (node.kind == N_IDENTIFIER) {
-      PUSH_CHAR('\n')
-      PUSH_CHAR('\t')
-
-      char *childName = node.data;
-      int i = 0;
-      while (childName[i]) {
-        PUSH_CHAR(childName[i])
-        ++i;
-      }
-    }
+  // C allows a comma after the last one
+  for (int i = DEF_BODY; i < n.children.len; ++i) {
+    PUSH_STR("\n\t")
+    pushSymbol(out, n.children.p[i].data);
+    PUSH_CHAR(',')
   }
 
   // typedef enum Test { }
-  PUSH_CHAR('\n')
-  PUSH_CHAR('}')
-  PUSH_CHAR(' ')
+  PUSH_STR("\n} ")
 
   // typedef enum Test { } Test;
-  i = 0;
-  while (enumName[i]) {
-    PUSH_CHAR(enumName[i])
-    ++i;
-  }
-  PUSH_CHAR(';')
-  PUSH_CHAR('\n')
-  PUSH_CHAR('\n')
+  pushSymbol(out, enumName);
+  PUSH_STR(";\n\n")
 }
 
-void emitEnums(Emitter *e, CharList *out) {
+void emitEnums(Emitter *e, EmitBuffer *out) {
   for (int i = 0; i < e->inEnums.children.len; i++) {
     emitEnum(e, out, e->inEnums.children.p[i]);
   }
 }
 
-void emitIdentifier(Emitter *e, CharList *out, Node n) {
-  if (cmpStr(n.data, e->nil)) {
-    PUSH_CHAR('N')
-    PUSH_CHAR('U')
-    PUSH_CHAR('L')
-    PUSH_CHAR('L')
+void emitIdentifier(Emitter *e, EmitBuffer *out, Node n) {
+  if (SAME_SYMBOL(n.data, e->nil)) {
+    PUSH_STR("NULL")
     return;
   }
 
-  char *name = n.data;
-  int i = 0;
-  while (name[i]) {
-    PUSH_CHAR(name[i])
-    ++i;
-  }
+  pushSymbol(out, n.data);
 }
 
-void emitOperator(Emitter *e, CharList *out, Node n) {
+void emitOperator(Emitter *e, EmitBuffer *out, Node n) {
   switch (n.kind) {
   case N_ADD:
     PUSH_CHAR('+')
@@ -149,42 +163,34 @@ void emitOperator(Emitter *e, CharList *out, Node n) {
     PUSH_CHAR('^')
     break;
   case N_ANDAND:
-    PUSH_CHAR('&')
-    PUSH_CHAR('&')
+    PUSH_STR("&&")
     break;
   case N_OROR:
-    PUSH_CHAR('|')
-    PUSH_CHAR('|')
+    PUSH_STR("||")
     break;
   case N_EQ:
-    PUSH_CHAR('=')
-    PUSH_CHAR('=')
+    PUSH_STR("==")
     break;
   case N_NEQ:
-    PUSH_CHAR('!')
-    PUSH_CHAR('=')
+    PUSH_STR("!=")
     break;
   case N_GT:
     PUSH_CHAR('>')
     break;
   case N_GTEQ:
-    PUSH_CHAR('>')
-    PUSH_CHAR('=')
+    PUSH_STR(">=")
     break;
   case N_LT:
     PUSH_CHAR('<')
     break;
   case N_LTEQ:
-    PUSH_CHAR('<')
-    PUSH_CHAR('=')
+    PUSH_STR("<=")
     break;
   case N_L_SHIFT:
-    PUSH_CHAR('<')
-    PUSH_CHAR('<')
+    PUSH_STR("<<")
     break;
   case N_R_SHIFT:
-    PUSH_CHAR('>')
-    PUSH_CHAR('>')
+    PUSH_STR(">>")
     break;
   default:
     printf("%s\n", nodeCodeString(n.kind));
@@ -192,48 +198,41 @@ void emitOperator(Emitter *e, CharList *out, Node n) {
   }
 }
 
-void emitBracketedValue(Emitter *e, CharList *out, Node n) {
+void emitBracketedValue(Emitter *e, EmitBuffer *out, Node n) {
   PUSH_CHAR('(')
-  emitExpression(e, out, n.children.p[1]);
+  emitExpression(e, out, n.children.p[0]);
   PUSH_CHAR(')')
 }
 
-void emitMakeArray(Emitter *e, CharList *out, Node n) {
+void emitMakeArray(Emitter *e, EmitBuffer *out, Node n) {
   PUSH_CHAR('{')
 
-  for (int i = 2; i < n.children.len - 1; ++i) {
-    Node node = n.children.p[i];
-    if (node.kind == N_EXPRESSION) {
-      emitExpression(e, out, node);
-    } else { // Sep
-      PUSH_CHAR(',')
-      PUSH_CHAR(' ')
+  for (int i = 0; i < n.children.len; ++i) {
+    if (i > 0) {
+      PUSH_STR(", ")
     }
+    emitExpression(e, out, n.children.p[i]);
   }
 
   PUSH_CHAR('}')
 }
 
-void emitStructNew(Emitter *e, CharList *out, Node n) {
+void emitStructNew(Emitter *e, EmitBuffer *out, Node n) {
   PUSH_CHAR('(')
-  emitIdentifier(e, out, n.children.p[1]);
-  PUSH_CHAR(')')
-  PUSH_CHAR('{')
+  emitIdentifier(e, out, n.children.p[CALL_NAME]);
+  PUSH_STR("){")
 
-  for (int i = 3; i < n.children.len - 1; ++i) {
-    Node node = n.children.p[i];
-    if (node.kind == N_EXPRESSION) {
-      emitExpression(e, out, node);
-    } else { // Sep
-      PUSH_CHAR(',')
-      PUSH_CHAR(' ')
+  for (int i = CALL_ARGS; i < n.children.len; ++i) {
+    if (i > CALL_ARGS) {
+      PUSH_STR(", ")
     }
+    emitExpression(e, out, n.children.p[i]);
   }
 
   PUSH_CHAR('}')
 }
 
-void emitValue(Emitter *e, CharList *out, Node n) {
+void emitValue(Emitter *e, EmitBuffer *out, Node n) {
   // NOTE: emitIdentifier works on anything that just emits its data, such as
   // numbers
 
@@ -269,17 +268,10 @@ void emitValue(Emitter *e, CharList *out, Node n) {
     emitAccess(e, out, n);
     break;
   case N_TRUE:
-    PUSH_CHAR('t');
-    PUSH_CHAR('r');
-    PUSH_CHAR('u');
-    PUSH_CHAR('e');
+    PUSH_STR("true")
     break;
   case N_FALSE:
-    PUSH_CHAR('f');
-    PUSH_CHAR('a');
-    PUSH_CHAR('l');
-    PUSH_CHAR('s');
-    PUSH_CHAR('e');
+    PUSH_STR("false")
     break;
   default:
     printf("%s\n", nodeCodeString(n.kind));
@@ -287,18 +279,16 @@ void emitValue(Emitter *e, CharList *out, Node n) {
   }
 }
 
-void emitUnary(Emitter *e, CharList *out, Node n) {
+void emitUnary(Emitter *e, EmitBuffer *out, Node n) {
   switch (n.kind) {
   case N_DEREF:
     PUSH_CHAR('^')
     break;
   case N_DEC:
-    PUSH_CHAR('-')
-    PUSH_CHAR('-')
+    PUSH_STR("--")
     break;
   case N_INC:
-    PUSH_CHAR('+')
-    PUSH_CHAR('+')
+    PUSH_STR("++")
     break;
   case N_NOT:
     PUSH_CHAR('!')
@@ -318,10 +308,53 @@ void emitUnary(Emitter *e, CharList *out, Node n) {
   }
 }
 
-void emitUnaryValue(Emitter *e, CharList *out, Node n) {
-  emitUnary(e, out, n.children.p[0]);
+// Emits an index read, such as [i]arr, as arr[i]
+void emitIndexRead(Emitter *e, EmitBuffer *out, Node n) {
+  Node node = n.children.p[UNARY_OPERAND];
+  if (node.kind == N_EXPRESSION && node.children.len > 1) {
+    PUSH_CHAR('(')
+    emitExpression(e, out, node);
+    PUSH_CHAR(')')
+  } else if (node.kind == N_EXPRESSION) {
+    emitExpression(e, out, node);
+  } else { // Unary value
+    emitUnaryValue(e, out, node);
+  }
+
+  emitIndex(e, out, n.children.p[UNARY_OP]);
+}
+
+// Emits `new T(...) as a copy of the struct on the heap, so it outlives the
+// function that made it
+void emitHeapNew(Emitter *e, EmitBuffer *out, Node n) {
+  Node name = n.children.p[CALL_NAME];
+
+  PUSH_STR("memcpy(malloc(sizeof(")
+  emitIdentifier(e, out, name);
+  PUSH_STR(")), &")
+  emitStructNew(e, out, n);
+  PUSH_STR(", sizeof(")
+  emitIdentifier(e, out, name);
+  PUSH_STR("))")
+}
+
+void emitUnaryValue(Emitter *e, EmitBuffer *out, Node n) {
+  Node node = n.children.p[UNARY_OPERAND];
+
+  if (n.children.p[UNARY_OP].kind == N_INDEX) {
+    emitIndexRead(e, out, n);
+    return;
+  }
+
+  if (n.children.p[UNARY_OP].kind == N_REF && node.kind == N_EXPRESSION &&
+      node.children.len == 1 &&
+      node.children.p[EXPR_LEFT].kind == N_STRUCT_NEW) {
+    emitHeapNew(e, out, node.children.p[EXPR_LEFT]);
+    return;
+  }
+
+  emitUnary(e, out, n.children.p[UNARY_OP]);
 
-  Node node = n.children.p[1];
   if (node.kind == N_EXPRESSION) {
     emitExpression(e, out, node);
   } else { // Unary value
@@ -329,9 +362,9 @@ void emitUnaryValue(Emitter *e, CharList *out, Node n) {
   }
 }
 
-void emitExpression(Emitter *e, CharList *out, Node n) {
+void emitExpression(Emitter *e, EmitBuffer *out, Node n) {
 
-  Node node = n.children.p[0];
+  Node node = n.children.p[EXPR_LEFT];
 
   if (node.kind == N_UNARY_VALUE) {
     emitUnaryValue(e, out, node);
@@ -339,11 +372,11 @@ void emitExpression(Emitter *e, CharList *out, Node n) {
     emitValue(e, out, node);
   }
 
-  for (int i = 1; i < n.children.len - 1; i += 2) {
-    node = n.children.p[i];
+  for (int i = 0; i + EXPR_RIGHT < n.children.len; i += EXPR_STEP) {
+    node = n.children.p[i + EXPR_OP];
     emitOperator(e, out, node);
 
-    node = n.children.p[i + 1];
+    node = n.children.p[i + EXPR_RIGHT];
     if (node.kind == N_UNARY_VALUE) {
       emitUnaryValue(e, out, node);
     } else {
@@ -352,13 +385,13 @@ void emitExpression(Emitter *e, CharList *out, Node n) {
   }
 }
 
-void emitIndex(Emitter *e, CharList *out, Node n) {
+void emitIndex(Emitter *e, EmitBuffer *out, Node n) {
   PUSH_CHAR('[')
-  emitExpression(e, out, n.children.p[1]);
+  emitExpression(e, out, n.children.p[0]);
   PUSH_CHAR(']')
 }
 
-void emitComplexType(Emitter *e, CharList *out, Node n) {
+void emitComplexType(Emitter *e, EmitBuffer *out, Node n) {
   // printf("CompType: %s\n", nodeCodeString(n.kind));
   // printf("CompType: %i\n", n.line);
 
@@ -367,151 +400,107 @@ void emitComplexType(Emitter *e, CharList *out, Node n) {
     return;
   }
 
-  if (n.children.p[0].kind == N_INDEX) {
-    emitComplexType(e, out, n.children.p[1]);
-    emitIndex(e, out, n.children.p[0]);
+  if (n.children.p[COMPLEX_TYPE_MOD].kind == N_INDEX) {
+    emitComplexType(e, out, n.children.p[COMPLEX_TYPE_INNER]);
+    emitIndex(e, out, n.children.p[COMPLEX_TYPE_MOD]);
   } else { // Pointer
-    emitComplexType(e, out, n.children.p[1]);
+    emitComplexType(e, out, n.children.p[COMPLEX_TYPE_INNER]);
     PUSH_CHAR('*')
   }
 }
 
-void emitStruct(Emitter *e, CharList *out, Node n) {
-  char *structName = n.children.p[1].data;
+void emitStruct(Emitter *e, EmitBuffer *out, Node n) {
+  char *structName = n.children.p[DEF_NAME].data;
 
   // typedef
-  PUSH_CHAR('t')
-  PUSH_CHAR('y')
-  PUSH_CHAR('p')
-  PUSH_CHAR('e')
-  PUSH_CHAR('d')
-  PUSH_CHAR('e')
-  PUSH_CHAR('f')
-  PUSH_CHAR(' ')
+  PUSH_STR("typedef ")
 
   // typedef struct
-  PUSH_CHAR('s')
-  PUSH_CHAR('t')
-  PUSH_CHAR('r')
-  PUSH_CHAR('u')
-  PUSH_CHAR('c')
-  PUSH_CHAR('t')
-  PUSH_CHAR(' ')
+  PUSH_STR("struct ")
 
-  emitIdentifier(e, out, n.children.p[1]);
+  emitIdentifier(e, out, n.children.p[DEF_NAME]);
   PUSH_CHAR(' ')
-  emitIdentifier(e, out, n.children.p[1]);
+  emitIdentifier(e, out, n.children.p[DEF_NAME]);
 
-  PUSH_CHAR(';')
-  PUSH_CHAR('\n')
+  PUSH_STR(";\n")
 
   // typedef
-  PUSH_CHAR('t')
-  PUSH_CHAR('y')
-  PUSH_CHAR('p')
-  PUSH_CHAR('e')
-  PUSH_CHAR('d')
-  PUSH_CHAR('e')
-  PUSH_CHAR('f')
-  PUSH_CHAR(' ')
+  PUSH_STR("typedef ")
 
   // typedef struct
-  PUSH_CHAR('s')
-  PUSH_CHAR('t')
-  PUSH_CHAR('r')
-  PUSH_CHAR('u')
-  PUSH_CHAR('c')
-  PUSH_CHAR('t')
-  PUSH_CHAR(' ')
+  PUSH_STR("struct ")
 
   // typedef struct Point
-  int i = 0;
-  while (structName[i]) {
-    PUSH_CHAR(structName[i])
-    ++i;
-  }
+  pushSymbol(out, structName);
   PUSH_CHAR(' ')
 
   // typedef struct Point {
-  PUSH_CHAR('{')
-  PUSH_CHAR('\n')
-  PUSH_CHAR('\t')
+  PUSH_STR("{\n\t")
 
   // typedef struct Point { int x; int y;
-  for (int i = 3; i < n.children.len - 1; ++i) {
+  for (int i = DEF_BODY; i < n.children.len; ++i) {
     Node node = n.children.p[i];
     if (node.kind == N_IDENTIFIER) {
       PUSH_CHAR(' ')
       emitIdentifier(e, out, node);
       PUSH_CHAR(' ')
-    } else if (node.kind == N_COMPLEX_TYPE) {
+    } else {
       emitComplexType(e, out, node);
-    } else if (node.kind == N_SEP) {
-      PUSH_CHAR(';')
-      PUSH_CHAR('\n')
-      PUSH_CHAR('\t')
+    }
+
+    // After each prop's name
+    if ((i - DEF_BODY) % 2 == 1) {
+      PUSH_STR(";\n\t")
     }
   }
 
   // typedef struct Point { int x; int y; } Point;
-  PUSH_CHAR('\n')
-  PUSH_CHAR('}')
+  PUSH_STR("\n}")
 
   PUSH_CHAR(' ')
-  i = 0;
-  while (structName[i]) {
-    PUSH_CHAR(structName[i])
-    ++i;
-  }
+  pushSymbol(out, structName);
   PUSH_CHAR(';')
 
-  PUSH_CHAR('\n')
-  PUSH_CHAR('\n')
+  PUSH_STR("\n\n")
 }
 
-void emitStructs(Emitter *e, CharList *out) {
+void emitStructs(Emitter *e, EmitBuffer *out) {
   for (int i = 0; i < e->inStructs.children.len; i++) {
     emitStruct(e, out, e->inStructs.children.p[i]);
   }
 }
 
-void emitFuncCall(Emitter *e, CharList *out, Node n) {
-  emitIdentifier(e, out, n.children.p[1]);
+void emitFuncCall(Emitter *e, EmitBuffer *out, Node n) {
+  emitIdentifier(e, out, n.children.p[CALL_NAME]);
   PUSH_CHAR('(')
 
-  for (int i = 3; i < n.children.len - 1; ++i) {
-    Node node = n.children.p[i];
-
-    if (node.kind == N_EXPRESSION) {
-      emitExpression(e, out, node);
-    } else { // Sep
-      PUSH_CHAR(',')
-      PUSH_CHAR('\n')
+  for (int i = CALL_ARGS; i < n.children.len; ++i) {
+    if (i > CALL_ARGS) {
+      PUSH_STR(",\n")
     }
+    emitExpression(e, out, n.children.p[i]);
   }
 
   PUSH_CHAR(')')
 }
 
-void emitLoneCall(Emitter *e, CharList *out, Node n) {
+void emitLoneCall(Emitter *e, EmitBuffer *out, Node n) {
   emitFuncCall(e, out, n.children.p[0]);
-  PUSH_CHAR(';')
-  PUSH_CHAR('\n')
+  PUSH_STR(";\n")
 }
 
-void emitAccess(Emitter *e, CharList *out, Node n) {
-  emitIdentifier(e, out, n.children.p[0]);
+void emitAccess(Emitter *e, EmitBuffer *out, Node n) {
+  emitIdentifier(e, out, n.children.p[ACCESS_BASE]);
 
-  Node node = n.children.p[1];
+  Node node = n.children.p[ACCESS_OP];
 
   if (node.kind == N_ACCESSOR) {
     PUSH_CHAR('.')
   } else { // P accessor
-    PUSH_CHAR('-')
-    PUSH_CHAR('>')
+    PUSH_STR("->")
   }
 
-  node = n.children.p[2];
+  node = n.children.p[ACCESS_MEMBER];
 
   if (node.kind == N_ACCESS) {
     emitAccess(e, out, node);
@@ -520,18 +509,16 @@ void emitAccess(Emitter *e, CharList *out, Node n) {
   }
 }
 
-void emitCrement(Emitter *e, CharList *out, Node n) {
-  Node node = n.children.p[0];
+void emitCrement(Emitter *e, EmitBuffer *out, Node n) {
+  Node node = n.children.p[CREMENT_OP];
 
   if (node.kind == N_INC) {
-    PUSH_CHAR('+')
-    PUSH_CHAR('+')
+    PUSH_STR("++")
   } else {
-    PUSH_CHAR('-')
-    PUSH_CHAR('-')
+    PUSH_STR("--")
   }
 
-  node = n.children.p[1];
+  node = n.children.p[CREMENT_TARGET];
 
   if (node.kind == N_ACCESS) {
     emitAccess(e, out, node);
@@ -539,205 +526,152 @@ void emitCrement(Emitter *e, CharList *out, Node n) {
     emitIdentifier(e, out, node);
   }
 
-  if (n.children.len == 3) {
-    emitIndex(e, out, n.children.p[2]);
+  if (n.children.len > CREMENT_INDEX) {
+    emitIndex(e, out, n.children.p[CREMENT_INDEX]);
   }
 }
 
-void emitAssignment(Emitter *e, CharList *out, Node n) {
-  if (n.children.p[0].kind == N_CREMENT) {
-    emitCrement(e, out, n.children.p[0]);
+void emitAssignment(Emitter *e, EmitBuffer *out, Node n) {
+  if (n.children.p[ASSIGN_TARGET].kind == N_CREMENT) {
+    emitCrement(e, out, n.children.p[ASSIGN_TARGET]);
     return;
   }
 
-  if (n.children.p[0].kind == N_ACCESS) {
-    emitAccess(e, out, n.children.p[0]);
+  if (n.children.p[ASSIGN_TARGET].kind == N_ACCESS) {
+    emitAccess(e, out, n.children.p[ASSIGN_TARGET]);
   } else {
-    emitIdentifier(e, out, n.children.p[0]);
+    emitIdentifier(e, out, n.children.p[ASSIGN_TARGET]);
   }
 
-  if (n.children.p[1].kind == N_INDEX) {
-    emitIndex(e, out, n.children.p[1]);
+  if (n.children.p[ASSIGN_INDEX].kind == N_INDEX) {
+    emitIndex(e, out, n.children.p[ASSIGN_INDEX]);
   }
 
-  PUSH_CHAR(' ')
-  PUSH_CHAR('=')
-  PUSH_CHAR(' ')
+  PUSH_STR(" = ")
 
   emitExpression(e, out, n.children.p[n.children.len - 1]);
 }
 
-void emitNewAssignment(Emitter *e, CharList *out, Node n) {
-  emitComplexType(e, out, n.children.p[1]);
-  PUSH_CHAR(' ')
-  emitIdentifier(e, out, n.children.p[2]);
-  PUSH_CHAR(' ')
-  PUSH_CHAR('=')
+// Emits the type and name of a declaration. C puts array sizes after the
+// name, so [3]int x becomes int x[3]
+void emitDeclaration(Emitter *e, EmitBuffer *out, Node type, Node name) {
+  Node base = type;
+  while (base.kind == N_COMPLEX_TYPE &&
+         base.children.p[COMPLEX_TYPE_MOD].kind == N_INDEX) {
+    base = base.children.p[COMPLEX_TYPE_INNER];
+  }
+
+  emitComplexType(e, out, base);
   PUSH_CHAR(' ')
-  emitExpression(e, out, n.children.p[4]);
+  emitIdentifier(e, out, name);
+
+  while (type.kind == N_COMPLEX_TYPE &&
+         type.children.p[COMPLEX_TYPE_MOD].kind == N_INDEX) {
+    emitIndex(e, out, type.children.p[COMPLEX_TYPE_MOD]);
+    type = type.children.p[COMPLEX_TYPE_INNER];
+  }
+}
+
+void emitNewAssignment(Emitter *e, EmitBuffer *out, Node n) {
+  emitDeclaration(e, out, n.children.p[NEW_ASSIGNMENT_TYPE],
+                  n.children.p[NEW_ASSIGNMENT_NAME]);
+  PUSH_STR(" = ")
+  emitExpression(e, out, n.children.p[NEW_ASSIGNMENT_EXPR]);
 }
 
-void emitVarDec(Emitter *e, CharList *out, Node n) {
+void emitVarDec(Emitter *e, EmitBuffer *out, Node n) {
   if (n.children.p[0].kind == N_ASSIGNMENT) {
     emitAssignment(e, out, n.children.p[0]);
   } else {
     emitNewAssignment(e, out, n.children.p[0]);
   }
 
-  PUSH_CHAR(';');
-  PUSH_CHAR('\n');
+  PUSH_STR(";\n")
 }
 
-void emitIfBlock(Emitter *e, CharList *out, Node n) {
-  PUSH_CHAR('i')
-  PUSH_CHAR('f')
-  PUSH_CHAR(' ')
-  PUSH_CHAR('(')
-
-  emitExpression(e, out, n.children.p[2]);
-
-  PUSH_CHAR(')')
-  PUSH_CHAR(' ')
+void emitIfBlock(Emitter *e, EmitBuffer *out, Node n) {
+  PUSH_STR("if (")
 
-  emitBlock(e, out, n.children.p[4]);
+  emitExpression(e, out, n.children.p[IF_COND]);
 
-  int i = 5;
+  PUSH_STR(") ")
 
-  if (i == n.children.len) {
-    PUSH_CHAR('\n')
-    PUSH_CHAR('\n')
-    return;
-  }
+  emitBlock(e, out, n.children.p[IF_THEN]);
 
-  while (n.children.p[i].kind == N_ELIF) {
-    PUSH_CHAR(' ')
-    PUSH_CHAR('e')
-    PUSH_CHAR('l')
-    PUSH_CHAR('s')
-    PUSH_CHAR('e')
-    PUSH_CHAR(' ')
-    PUSH_CHAR('i')
-    PUSH_CHAR('f')
-    PUSH_CHAR(' ')
-    PUSH_CHAR('(')
+  int i = IF_STEP;
 
-    emitExpression(e, out, n.children.p[i + 2]);
+  for (; i + IF_THEN < n.children.len; i += IF_STEP) {
+    PUSH_STR(" else if (")
 
-    PUSH_CHAR(')')
-    PUSH_CHAR(' ')
+    emitExpression(e, out, n.children.p[i + IF_COND]);
 
-    emitBlock(e, out, n.children.p[i + 4]);
+    PUSH_STR(") ")
 
-    i += 5;
-
-    if (i == n.children.len) {
-      PUSH_CHAR('\n')
-      PUSH_CHAR('\n')
-      return;
-    }
+    emitBlock(e, out, n.children.p[i + IF_THEN]);
   }
 
-  if (n.children.p[i].kind == N_ELSE) {
-    PUSH_CHAR(' ')
-    PUSH_CHAR('e')
-    PUSH_CHAR('l')
-    PUSH_CHAR('s')
-    PUSH_CHAR('e')
-    PUSH_CHAR(' ')
+  if (i < n.children.len) {
+    PUSH_STR(" else ")
 
-    emitBlock(e, out, n.children.p[i + 1]);
+    emitBlock(e, out, n.children.p[i]);
   }
 
-  PUSH_CHAR('\n')
-  PUSH_CHAR('\n')
+  PUSH_STR("\n\n")
 }
 
-void emitForLoop(Emitter *e, CharList *out, Node n) {
+void emitForLoop(Emitter *e, EmitBuffer *out, Node n) {
 
-  PUSH_CHAR('f')
-  PUSH_CHAR('o')
-  PUSH_CHAR('r')
-  PUSH_CHAR(' ')
-  PUSH_CHAR('(')
-  PUSH_CHAR(' ')
+  PUSH_STR("for ( ")
 
-  for (int i = 1; i < n.children.len - 1; ++i) {
+  for (int i = FOR_INIT; i < FOR_BLOCK; ++i) {
     Node node = n.children.p[i];
 
+    if (i > FOR_INIT) {
+      PUSH_STR("; ")
+    }
+
     if (node.kind == N_ASSIGNMENT) {
       emitAssignment(e, out, node);
     } else if (node.kind == N_NEW_ASSIGNMENT) {
       emitNewAssignment(e, out, node);
     } else if (node.kind == N_EXPRESSION) {
       emitExpression(e, out, node);
-    } else if (node.kind == N_SEMICOLON) {
-      PUSH_CHAR(';')
-      PUSH_CHAR(' ')
     }
   }
 
-  PUSH_CHAR(')')
-  PUSH_CHAR(' ')
-  emitBlock(e, out, n.children.p[n.children.len - 1]);
-  PUSH_CHAR('\n')
-  PUSH_CHAR('\n')
+  PUSH_STR(") ")
+  emitBlock(e, out, n.children.p[FOR_BLOCK]);
+  PUSH_STR("\n\n")
 }
 
-void emitRetState(Emitter *e, CharList *out, Node n) {
-  PUSH_CHAR('r')
-  PUSH_CHAR('e')
-  PUSH_CHAR('t')
-  PUSH_CHAR('u')
-  PUSH_CHAR('r')
-  PUSH_CHAR('n')
-  PUSH_CHAR(' ')
+void emitRetState(Emitter *e, EmitBuffer *out, Node n) {
+  PUSH_STR("return ")
 
-  if (n.children.p[1].kind == N_EXPRESSION) {
-    emitExpression(e, out, n.children.p[1]);
+  if (n.children.len == 1) {
+    emitExpression(e, out, n.children.p[0]);
   }
 
-  PUSH_CHAR(';')
-  PUSH_CHAR('\n')
+  PUSH_STR(";\n")
 }
 
-void emitBreakState(Emitter *e, CharList *out, Node n) {
-  PUSH_CHAR('b')
-  PUSH_CHAR('r')
-  PUSH_CHAR('e')
-  PUSH_CHAR('a')
-  PUSH_CHAR('k')
-  PUSH_CHAR(';')
-  PUSH_CHAR('\n')
+void emitBreakState(Emitter *e, EmitBuffer *out, Node n) {
+  PUSH_STR("break;\n")
 }
 
-void emitContinueState(Emitter *e, CharList *out, Node n) {
-  PUSH_CHAR('c')
-  PUSH_CHAR('o')
-  PUSH_CHAR('n')
-  PUSH_CHAR('t')
-  PUSH_CHAR('i')
-  PUSH_CHAR('n')
-  PUSH_CHAR('u')
-  PUSH_CHAR('e')
-  PUSH_CHAR(';')
-  PUSH_CHAR('\n')
+void emitContinueState(Emitter *e, EmitBuffer *out, Node n) {
+  PUSH_STR("continue;\n")
 }
 
-void emitCaseBlock(Emitter *e, CharList *out, Node n) {
-  PUSH_CHAR('c')
-  PUSH_CHAR('a')
-  PUSH_CHAR('s')
-  PUSH_CHAR('e')
-  PUSH_CHAR(' ')
+void emitCaseBlock(Emitter *e, EmitBuffer *out, Node n) {
+  PUSH_STR("case ")
 
-  emitExpression(e, out, n.children.p[1]);
+  emitExpression(e, out, n.children.p[CASE_EXPR]);
 
-  PUSH_CHAR(':')
-  PUSH_CHAR('\n')
+  PUSH_STR(":\n")
 
   ++e->tabs;
 
-  for (int i = 3; i < n.children.len; ++i) {
+  for (int i = CASE_STATEMENTS; i < n.children.len; ++i) {
     Node node = n.children.p[i];
 
     emitTabs(e, out);
@@ -778,21 +712,12 @@ void emitCaseBlock(Emitter *e, CharList *out, Node n) {
   PUSH_CHAR('\n')
 }
 
-void emitDefaultBlock(Emitter *e, CharList *out, Node n) {
-  PUSH_CHAR('d')
-  PUSH_CHAR('e')
-  PUSH_CHAR('f')
-  PUSH_CHAR('a')
-  PUSH_CHAR('u')
-  PUSH_CHAR('l')
-  PUSH_CHAR('t')
-  PUSH_CHAR(' ')
-  PUSH_CHAR(':')
-  PUSH_CHAR('\n')
+void emitDefaultBlock(Emitter *e, EmitBuffer *out, Node n) {
+  PUSH_STR("default :\n")
 
   ++e->tabs;
 
-  for (int i = 2; i < n.children.len; ++i) {
+  for (int i = 0; i < n.children.len; ++i) {
     Node node = n.children.p[i];
 
     emitTabs(e, out);
@@ -833,52 +758,40 @@ void emitDefaultBlock(Emitter *e, CharList *out, Node n) {
   PUSH_CHAR('\n')
 }
 
-void emitSwitchState(Emitter *e, CharList *out, Node n) {
-  PUSH_CHAR('s')
-  PUSH_CHAR('w')
-  PUSH_CHAR('i')
-  PUSH_CHAR('t')
-  PUSH_CHAR('c')
-  PUSH_CHAR('h')
-  PUSH_CHAR(' ')
-  PUSH_CHAR('(')
+void emitSwitchState(Emitter *e, EmitBuffer *out, Node n) {
+  PUSH_STR("switch (")
 
-  emitExpression(e, out, n.children.p[2]);
+  emitExpression(e, out, n.children.p[SWITCH_EXPR]);
 
   PUSH_CHAR(')')
 
-  PUSH_CHAR('{')
-  PUSH_CHAR('\n')
+  PUSH_STR("{\n")
 
-  for (int i = 5; i < n.children.len - 1; ++i) {
+  for (int i = SWITCH_CASES; i < n.children.len; ++i) {
     Node node = n.children.p[i];
+    emitTabs(e, out);
     if (node.kind == N_CASE_BLOCK) {
-      emitTabs(e, out);
       emitCaseBlock(e, out, node);
-    } else if (node.kind == N_DEFAULT_BLOCK) {
-      emitTabs(e, out);
+    } else {
       emitDefaultBlock(e, out, node);
     }
   }
 
   emitTabs(e, out);
-  PUSH_CHAR('}')
-  PUSH_CHAR('\n')
-  PUSH_CHAR('\n')
+  PUSH_STR("}\n\n")
 }
 
-void emitBlock(Emitter *e, CharList *out, Node n) {
+void emitBlock(Emitter *e, EmitBuffer *out, Node n) {
 
   // char *p = nodeString(&n);
   // printf("%s\n", p);
   // free(p);
 
-  PUSH_CHAR('{')
-  PUSH_CHAR('\n')
+  PUSH_STR("{\n")
 
   ++e->tabs;
 
-  for (int i = 1; i < n.children.len - 1; ++i) {
+  for (int i = 0; i < n.children.len; ++i) {
     Node node = n.children.p[i];
 
     emitTabs(e, out);
@@ -921,124 +834,92 @@ void emitBlock(Emitter *e, CharList *out, Node n) {
   PUSH_CHAR('}')
 }
 
-void emitFun(Emitter *e, CharList *out, Node n) {
-  int sub = 1;
+void emitFun(Emitter *e, EmitBuffer *out, Node n) {
   // Return type
-  Node returnNode = n.children.p[n.children.len - 2];
-  if (returnNode.kind == N_IDENTIFIER || returnNode.kind == N_COMPLEX_TYPE) {
-    emitComplexType(e, out, n.children.p[n.children.len - 2]);
-    sub++;
+  Node returnNode = n.children.p[FUNC_DEF_RET];
+  if (returnNode.kind != N_EMPTY) {
+    emitComplexType(e, out, returnNode);
   } else {
-    PUSH_CHAR('v')
-    PUSH_CHAR('o')
-    PUSH_CHAR('i')
-    PUSH_CHAR('d')
+    PUSH_STR("void")
   }
 
   // Name
   PUSH_CHAR(' ')
-  emitIdentifier(e, out, n.children.p[1]);
+  emitIdentifier(e, out, n.children.p[DEF_NAME]);
 
   // l brace
   PUSH_CHAR('(')
 
-  // Params
-  for (int i = 3; i < n.children.len - sub; ++i) {
+  // Params, a comma comes before each type but the first
+  for (int i = FUNC_DEF_PARAMS; i < n.children.len; ++i) {
     Node node = n.children.p[i];
 
+    if (i > FUNC_DEF_PARAMS && (i - FUNC_DEF_PARAMS) % 2 == 0) {
+      PUSH_CHAR(',')
+    }
+
+    PUSH_CHAR(' ')
     if (node.kind == N_COMPLEX_TYPE) {
-      PUSH_CHAR(' ')
       emitComplexType(e, out, node);
-    } else if (node.kind == N_IDENTIFIER) {
-      PUSH_CHAR(' ')
+    } else {
       emitIdentifier(e, out, node);
-    } else if (node.kind == N_SEP) {
-      PUSH_CHAR(',')
     }
   }
 
   // r brace
-  PUSH_CHAR(')')
-  PUSH_CHAR(' ')
+  PUSH_STR(") ")
 
   // block
-  emitBlock(e, out, n.children.p[n.children.len - 1]);
-  PUSH_CHAR('\n')
-  PUSH_CHAR('\n')
+  emitBlock(e, out, n.children.p[FUNC_DEF_BLOCK]);
+  PUSH_STR("\n\n")
 }
 
-void emitFuns(Emitter *e, CharList *out) {
+void emitFuns(Emitter *e, EmitBuffer *out) {
   for (int i = 0; i < e->inFuns.children.len; i++) {
+    TRACE_BEGIN("emit", e->inFuns.children.p[i].children.p[DEF_NAME].data);
     emitFun(e, out, e->inFuns.children.p[i]);
+    TRACE_END("emit", e->inFuns.children.p[i].children.p[DEF_NAME].data);
   }
 }
 
-void emitHeaders(Emitter *e, CharList *out) {
-  PUSH_CHAR('#');
-  PUSH_CHAR('i');
-  PUSH_CHAR('n');
-  PUSH_CHAR('c');
-  PUSH_CHAR('l');
-  PUSH_CHAR('u');
-  PUSH_CHAR('d');
-  PUSH_CHAR('e');
-  PUSH_CHAR(' ');
-  PUSH_CHAR('<');
-  PUSH_CHAR('s');
-  PUSH_CHAR('t');
-  PUSH_CHAR('r');
-  PUSH_CHAR('i');
-  PUSH_CHAR('n');
-  PUSH_CHAR('g')
-  PUSH_CHAR('.');
-  PUSH_CHAR('h');
-  PUSH_CHAR('>');
-  PUSH_CHAR('\n');
-
-  PUSH_CHAR('#');
-  PUSH_CHAR('i');
-  PUSH_CHAR('n');
-  PUSH_CHAR('c');
-  PUSH_CHAR('l');
-  PUSH_CHAR('u');
-  PUSH_CHAR('d');
-  PUSH_CHAR('e');
-  PUSH_CHAR(' ');
-  PUSH_CHAR('<');
-  PUSH_CHAR('s');
-  PUSH_CHAR('t');
-  PUSH_CHAR('d');
-  PUSH_CHAR('b');
-  PUSH_CHAR('o');
-  PUSH_CHAR('o');
-  PUSH_CHAR('l');
-  PUSH_CHAR('.');
-  PUSH_CHAR('h');
-  PUSH_CHAR('>');
-  PUSH_CHAR('\n');
-
-  PUSH_CHAR('\n');
-}
+void emitHeaders(Emitter *e, EmitBuffer *out) {
+  PUSH_STR("#include <string.h>\n")
+
+  PUSH_STR("#include <stdlib.h>\n")
 
-CharList emit(Emitter *e) {
-  CharList out;
+  PUSH_STR("#include <stdbool.h>\n")
 
-  if (CharListInit(&out, 1)) {
-    panic("Couldn't initialise output list");
+  PUSH_CHAR('\n')
+}
+
+errno_t emit(Emitter *e, FILE *dest) {
+  // Too big for the stack
+  EmitBuffer *out = malloc(sizeof(EmitBuffer));
+  if (out == NULL) {
+    panic("Couldn't allocate output buffer");
   }
-  // printf("Initialised emitting list\n");
+  STAT_ALLOC(SUB_CHARS, sizeof(EmitBuffer))
 
-  emitHeaders(e, &out);
+  out->dest = dest;
+  out->len = 0;
+  out->failed = false;
+
+  emitHeaders(e, out);
   // printf("Emitted headers\n");
 
-  emitEnums(e, &out);
+  emitEnums(e, out);
   // printf("Emitted enums\n");
 
-  emitStructs(e, &out);
+  emitStructs(e, out);
   // printf("Emitted structs\n");
 
-  emitFuns(e, &out);
+  emitFuns(e, out);
   // printf("Emitted functions\n");
 
-  return out;
+  flushEmitBuffer(out);
+  errno_t failed = out->failed;
+
+  STAT_FREE(SUB_CHARS, sizeof(EmitBuffer))
+  free(out);
+  return failed;
 }
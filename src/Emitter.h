@@ -1,9 +1,12 @@
 #pragma once
 
-#include "CharList.h"
 #include "Node.h"
 #include "StringManager.h"
 
+#include <corecrt.h>
+#include <stdbool.h>
+#include <stdio.h>
+
 typedef struct Emitter {
   // Source
   Node inEnums, inStructs, inFuns;
@@ -17,7 +20,20 @@ typedef struct Emitter {
   StringManager *sm;
 } Emitter;
 
+// Emitted C is gathered here and written out each time it fills, so the whole
+// program is never held in memory at once
+#define EMIT_BUFFER_SIZE (1 << 16)
+
+typedef struct EmitBuffer {
+  FILE *dest;
+  int len;
+  bool failed; // Some of the output couldn't be written
+  char p[EMIT_BUFFER_SIZE];
+} EmitBuffer;
+
 void emitterInit(Emitter *e, Node enums, Node structs, Node funs,
                  StringManager *sm);
 
-CharList emit(Emitter *e);
+// Writes the program to dest, returns non-zero if any of it couldn't be
+// written
+errno_t emit(Emitter *e, FILE *dest);
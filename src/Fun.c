@@ -1,12 +1,8 @@
 #include "Fun.h"
-#include "Panic.h"
 #include <stdlib.h>
 
 void funStackPush(FunStack *s, char *name) {
-  Fun *n = calloc(1, sizeof(Fun));
-  if (n == NULL) {
-    panic("Couldn't allocated node for stack");
-  }
+  Fun *n = arenaAlloc(s->arena, sizeof(Fun));
 
   n->name = name;
 
@@ -26,8 +22,6 @@ void funStackPush(FunStack *s, char *name) {
   s->tail = n;
 }
 
-// The reason we return the thing and not the pointer to the thing is because we
-// free the pointer, so we're returning a copy
 Fun funStackPop(FunStack *s) {
   if (s->len == 0) {
     return ZERO_FUN;
@@ -35,21 +29,12 @@ Fun funStackPop(FunStack *s) {
 
   --s->len;
 
-  if (s->len == 0) {
-    Fun tail = *(s->tail);
-    free(s->tail);
-    s->tail = NULL;
-    return tail;
-  }
-
-  Fun tail = *(s->tail);
-  free(s->tail);
-  s->tail = s->tail->next;
-  return tail;
+  Fun *tail = s->tail;
+  s->tail = s->len == 0 ? NULL : tail->next;
+  return *tail;
 }
 
 void funStackClear(FunStack *s) {
-  while (s->len > 0) {
-    funStackPop(s);
-  }
+  s->tail = NULL;
+  s->len = 0;
 }
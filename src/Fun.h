@@ -19,10 +19,13 @@ typedef struct Fun {
 typedef struct FunStack {
   Fun *tail;
   int len;
+  Arena *arena; // Where pushes come from, popping doesn't give anything back
 } FunStack;
 
+// Returns a copy of what was on top
 Fun funStackPop(FunStack *s);
 
 void funStackPush(FunStack *s, char *name);
 
+// Empties the stack in one step, the memory goes with the arena
 void funStackClear(FunStack *s);
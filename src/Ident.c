@@ -1,12 +1,8 @@
 #include "Ident.h"
-#include "Panic.h"
 #include <stdlib.h>
 
 void identStackPush(IdentStack *s, char *name, Type *type) {
-  Ident *n = calloc(1, sizeof(Ident));
-  if (n == NULL) {
-    panic("Couldn't allocated node for stack");
-  }
+  Ident *n = arenaAlloc(s->arena, sizeof(Ident));
 
   n->name = name;
   n->type = type;
@@ -22,8 +18,6 @@ void identStackPush(IdentStack *s, char *name, Type *type) {
   s->tail = n;
 }
 
-// The reason we return the thing and not the pointer to the thing is because we
-// free the pointer, so we're returning a copy
 Ident identStackPop(IdentStack *s) {
   if (s->len == 0) {
     return ZERO_IDENT;
@@ -31,21 +25,12 @@ Ident identStackPop(IdentStack *s) {
 
   --s->len;
 
-  if (s->len == 0) {
-    Ident tail = *(s->tail);
-    free(s->tail);
-    s->tail = NULL;
-    return tail;
-  }
-
-  Ident tail = *(s->tail);
-  free(s->tail);
-  s->tail = s->tail->next;
-  return tail;
+  Ident *tail = s->tail;
+  s->tail = s->len == 0 ? NULL : tail->next;
+  return *tail;
 }
 
 void identStackClear(IdentStack *s) {
-  while (s->len > 0) {
-    identStackPop(s);
-  }
+  s->tail = NULL;
+  s->len = 0;
 }
@@ -2,6 +2,7 @@
 
 typedef struct Ident Ident;
 
+#include "Arena.h"
 #include "TypeModifier.h"
 #include "Types.h"
 
@@ -18,10 +19,13 @@ typedef struct Ident {
 typedef struct IdentStack {
   Ident *tail;
   int len;
+  Arena *arena; // Where pushes come from, popping doesn't give anything back
 } IdentStack;
 
+// Returns a copy of what was on top
 Ident identStackPop(IdentStack *s);
 
 void identStackPush(IdentStack *s, char *name, Type *type);
 
+// Empties the stack in one step, the memory goes with the arena
 void identStackClear(IdentStack *s);
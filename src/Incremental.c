@@ -0,0 +1,162 @@
+#include "Incremental.h"
+
+#ifndef _WIN32
+
+#include "Node.h"
+#include "Panic.h"
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+errno_t incrementalInit(Incremental *inc) {
+  inc->files = NULL;
+  inc->fileCount = 0;
+  inc->fileCap = 0;
+  return initStringManager(&inc->sm);
+}
+
+CachedFile *findCachedFile(Incremental *inc, char *path) {
+  for (int i = 0; i < inc->fileCount; ++i) {
+    if (!strcmp(inc->files[i].path, path)) {
+      return inc->files + i;
+    }
+  }
+
+  if (inc->fileCount == inc->fileCap) {
+    inc->fileCap = inc->fileCap ? inc->fileCap * 2 : 16;
+    inc->files = realloc(inc->files, sizeof(CachedFile) * inc->fileCap);
+    if (inc->files == NULL) {
+      panic("Couldn't grow the file cache");
+    }
+  }
+
+  CachedFile *f = inc->files + inc->fileCount;
+  ++inc->fileCount;
+
+  f->path = strdup(path);
+  f->name = NULL;
+  f->hash = 0;
+  f->tree = ZERO_NODE;
+  arenaInit(&f->arena, SUB_NODES);
+  return f;
+}
+
+// Runs the back end in a child process, the optimiser changes the trees it's
+// given and an analyser error exits, neither should touch the cached trees
+int compileCached(Incremental *inc, Options *o, CachedFile *cached[],
+                  TimeReport *report) {
+  Parser parsers[o->fileCount > 0 ? o->fileCount : 1];
+  for (int i = 0; i < o->fileCount; ++i) {
+    parsers[i].sourceName = cached[i]->name;
+    parsers[i].out = cached[i]->tree;
+  }
+
+  fflush(stdout);
+  fflush(stderr);
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    printf("Couldn't start the back end\n");
+    return 1;
+  }
+
+  if (pid == 0) {
+    backEnd(parsers, o->fileCount, o, &inc->sm, report);
+    printf("Finished\n");
+    printTimeReport(report);
+    exit(0);
+  }
+
+  int status;
+  if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status)) {
+    return 1;
+  }
+  return WEXITSTATUS(status);
+}
+
+int incrementalCompile(Incremental *inc, Options *o) {
+  char **fileNames = o->fileNames;
+
+  // A file with the same contents under a different name is still parsed
+  // again, the name ends up in error messages
+  CachedFile *cached[o->fileCount];
+  unsigned long long hashes[o->fileCount];
+  char *changedNames[o->fileCount];
+  int changed[o->fileCount];
+  int changedCount = 0;
+
+  for (int i = 0; i < o->fileCount; ++i) {
+    char path[PATH_MAX];
+    if (realpath(fileNames[i], path) == NULL ||
+        hashFile(path, hashes + i)) {
+      printf("Couldn't open file %s\n", fileNames[i]);
+      return 1;
+    }
+
+    cached[i] = findCachedFile(inc, path);
+    if (cached[i]->name != NULL && cached[i]->hash == hashes[i] &&
+        !strcmp(cached[i]->name, fileNames[i])) {
+      continue;
+    }
+
+    // Given twice in one compile, only parse it once
+    bool seen = false;
+    for (int j = 0; j < changedCount; ++j) {
+      seen = seen || cached[changed[j]] == cached[i];
+    }
+    if (seen) {
+      continue;
+    }
+
+    changedNames[changedCount] = strdup(fileNames[i]);
+    changed[changedCount] = i;
+    ++changedCount;
+  }
+
+  TimeReport report;
+  timeReportInit(&report, o->reportFormat, changedCount);
+
+  printf("Lexing and parsing %i of %i files\n", changedCount, o->fileCount);
+  Stopwatch sw = startStopwatch(&report, false);
+  Parser parsers[changedCount > 0 ? changedCount : 1];
+  for (int j = 0; j < changedCount; ++j) {
+    parsers[j].out = ZERO_NODE;
+  }
+  errno_t failed = frontEnd(changedNames, changedCount, parsers, o->jobs,
+                            &inc->sm, &report, true, o->cacheDir);
+  endPhase(&report, sw, "Lexing and parsing");
+  printf("End lexing and parsing\n\n");
+
+  // Keep whatever parsed, even if another file didn't, so it isn't parsed
+  // again next time
+  for (int j = 0; j < changedCount; ++j) {
+    if (parsers[j].out.kind != N_PROGRAM) {
+      arenaDestroy(&parsers[j].arena);
+      free(changedNames[j]);
+      continue;
+    }
+
+    // The old tree goes all at once with its arena
+    CachedFile *f = cached[changed[j]];
+    if (f->name != NULL) {
+      arenaDestroy(&f->arena);
+      free(f->name);
+    }
+
+    f->name = changedNames[j];
+    f->hash = hashes[changed[j]];
+    f->tree = parsers[j].out;
+    f->arena = parsers[j].arena;
+  }
+
+  int status = failed ? 1 : compileCached(inc, o, cached, &report);
+  timeReportDestroy(&report);
+  return status;
+}
+
+#endif
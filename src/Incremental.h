@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Compile.h"
+#include "Node.h"
+#include "StringManager.h"
+
+#include <corecrt.h>
+
+// Keeps the string manager and every file's parse tree between compiles, so
+// a long-running process only parses the files whose contents changed. Used
+// by the compile server and watch mode, only available where there's fork
+
+typedef struct CachedFile {
+  char *path; // Absolute, so the same file is found from any directory
+  char *name; // As it was given, the tree's nodes point at this
+  unsigned long long hash;
+  Node tree;
+  Arena arena; // Holds tree
+} CachedFile;
+
+typedef struct Incremental {
+  StringManager sm;
+  CachedFile *files;
+  int fileCount;
+  int fileCap;
+} Incremental;
+
+errno_t incrementalInit(Incremental *inc);
+
+// Compiles the files in o, which have already been validated, parsing only
+// the ones that are new or changed. Returns the compile's exit code
+int incrementalCompile(Incremental *inc, Options *o);
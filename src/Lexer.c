@@ -1,5 +1,7 @@
 #include "Lexer.h"
 #include "Panic.h"
+#include "Scan.h"
+#include "Stats.h"
 #include "StringManager.h"
 #include "Token.h"
 
@@ -7,67 +9,181 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <threads.h>
 
 #define IS_DIGIT(VAL) ((VAL) >= '0' && (VAL) <= '9')
 #define IS_ALPHA(VAL)                                                          \
   ((VAL) >= 'a' && (VAL) <= 'z') || ((VAL) >= 'A' && (VAL) <= 'Z')
 #define VALID_IDENT_CHAR(VAL) (IS_ALPHA(VAL) || IS_DIGIT(VAL) || (VAL) == '_')
 #define VALID_NUM_CHAR(VAL) (IS_DIGIT(VAL) || (VAL) == '.' || (VAL) == '_')
-#define STR_BUFF_SIZE 100
+
+typedef struct Keyword {
+  char *word;
+  int len;
+  TokenCode kind;
+} Keyword;
+
+// A perfect hash of the keywords. Bits 2 to 7 of each keyword's string manager
+// hash are all different, so an identifier only ever has to be checked against
+// the one keyword in its slot. If a keyword is added, or the string manager's
+// hash changes, these need to be found again. checkKeywords catches a table
+// that has gone stale
+#define KEYWORD_SLOTS 64
+#define KEYWORD_SHIFT 2
+
+const Keyword keywords[KEYWORD_SLOTS] = {
+    [0] = {"enum", 4, T_ENUM},         [1] = {"if", 2, T_IF},
+    [4] = {"new", 3, T_NEW},           [8] = {"struct", 6, T_STRUCT},
+    [17] = {"continue", 8, T_CONTINUE}, [22] = {"false", 5, T_FALSE},
+    [23] = {"fun", 3, T_FUN},          [28] = {"switch", 6, T_SWITCH},
+    [30] = {"break", 5, T_BREAK},      [36] = {"for", 3, T_FOR},
+    [42] = {"call", 4, T_CALL},        [43] = {"make", 4, T_MAKE},
+    [44] = {"case", 4, T_CASE},        [47] = {"return", 6, T_RETURN},
+    [48] = {"elif", 4, T_ELIF},        [53] = {"const", 5, T_CONST},
+    [55] = {"default", 7, T_DEFAULT},  [57] = {"true", 4, T_TRUE},
+    [60] = {"else", 4, T_ELSE},        [62] = {"let", 3, T_LET},
+};
+
+once_flag keywordOnce = ONCE_FLAG_INIT;
+
+// Makes sure every keyword hashes to the slot it sits in. With one keyword per
+// slot that also rules out two keywords sharing a slot. This runs inside
+// call_once, so it exits rather than panicking into a file's error recovery
+void checkKeywords(void) {
+  for (int i = 0; i < KEYWORD_SLOTS; ++i) {
+    const Keyword *kw = keywords + i;
+    if (kw->word == NULL) {
+      continue;
+    }
+
+    if ((int)strlen(kw->word) != kw->len) {
+      printf("Keyword \"%s\" has the wrong length\n", kw->word);
+      exit(1);
+    }
+
+    unsigned int hash = hashSlice(kw->word, kw->len);
+    int slot = (hash >> KEYWORD_SHIFT) & (KEYWORD_SLOTS - 1);
+    if (slot != i) {
+      printf("Keyword \"%s\" is in slot %d but hashes to slot %d\n", kw->word,
+             i, slot);
+      exit(1);
+    }
+  }
+}
 
 void nextChar(Lexer *l) {
   l->curChar = l->peekChar;
-  l->peekChar = fgetc(l->source);
+
+  // Like fgetc, keep giving EOF once the source runs out. pos keeps counting so
+  // that curChar is always at pos - 2
+  if (l->pos < l->sourceLen) {
+    l->peekChar = l->source[l->pos];
+  } else {
+    l->peekChar = EOF;
+  }
+  ++l->pos;
 
   if (l->curChar == '\n') {
     ++l->line;
   }
 }
 
-void lexerInit(Lexer *l, char sourceName[], FILE *source, StringManager *sm) {
+// Makes the byte at index to the current character, as though nextChar had been
+// called up to it. Newlines before to must already have been counted
+void jumpTo(Lexer *l, int to) {
+  l->pos = to;
+  l->peekChar = 0;
+  nextChar(l);
+  nextChar(l);
+}
+
+// Reads the whole file into memory with a single read
+errno_t readSource(Lexer *l) {
+  FILE *f;
+  if (fopen_s(&f, l->sourceName, "rb")) {
+    return 1;
+  }
+
+  if (fseek(f, 0, SEEK_END)) {
+    fclose(f);
+    return 1;
+  }
+
+  long size = ftell(f);
+  if (size < 0 || fseek(f, 0, SEEK_SET)) {
+    fclose(f);
+    return 1;
+  }
+
+  l->source = malloc(size > 0 ? size : 1);
+  if (l->source == NULL) {
+    fclose(f);
+    return 1;
+  }
+  STAT_ALLOC(SUB_SOURCE, size > 0 ? size : 1)
+
+  l->sourceLen = fread(l->source, sizeof(char), size, f);
+  fclose(f);
+
+  if (l->sourceLen != size) {
+    STAT_FREE(SUB_SOURCE, size > 0 ? size : 1)
+    free(l->source);
+    return 1;
+  }
+
+  return 0;
+}
+
+errno_t lexerInit(Lexer *l, char sourceName[], StringManager *sm) {
   l->sourceName = sourceName;
-  l->source = source;
   l->line = 1;
   l->peekChar = 0;
   l->sm = sm;
+  l->pos = 0;
+
+  initScan();
+  call_once(&keywordOnce, checkKeywords);
+
+  if (readSource(l)) {
+    return 1;
+  }
 
   nextChar(l);
   nextChar(l);
 
-  if (TokenListInit(&l->out, 8)) {
-    panic("Couldn't initialise token list.");
-  }
+  return 0;
+}
+
+void lexerDestroy(Lexer *l) {
+  STAT_FREE(SUB_SOURCE, l->sourceLen > 0 ? l->sourceLen : 1)
+  free(l->source);
 }
 
 void throwLexerError(Lexer *l, char expected[], char got) {
   printf("Error in the Lexer!\n"
          "Error found in file: %s\nOn line: %i\nExpected: %s\nGot: %c (%i)\n",
          l->sourceName, l->line, expected, got, got);
-  exit(1);
+  fail();
 }
 
-// Returns the tokens of the source in the lexer, the resulting list must be
-// destroyed
-void lex(Lexer *l) {
-  Token token = {NULL, T_ILLEGAL, 0};
-  char p;
-  char *text;
-  char strBuff[STR_BUFF_SIZE];
-  int dynLen; // Length of variable sized token text
-  bool escaped;
-
-  // A NO_TOKEN in this loop means skipping the token append
+// Returns the next token in the source, or a ZERO_TOKEN once the source has run
+// out
+Token lexToken(Lexer *l) {
+  Token token = ZERO_TOKEN;
+  int start; // Where variable sized token text starts in the source
+  int end;
+
+  // A NO_TOKEN in this loop means skipping to the next character without
+  // returning a token
   while (l->curChar >= 0) {
     switch (l->curChar) {
-      // Skip these
+      // Skip these, along with any that follow
     case ' ':
-      goto NO_TOKEN;
     case '\t':
-      goto NO_TOKEN;
     case '\n':
-      goto NO_TOKEN;
     case '\r':
-      goto NO_TOKEN;
+      jumpTo(l, scanSpace(l->source, l->pos - 1, l->sourceLen, &l->line));
+      continue;
     case 0:
       throwLexerError(l, "More source", 0);
 
@@ -198,21 +314,24 @@ void lex(Lexer *l) {
       // Comment, divide
     case '/':
       if (l->peekChar == '/') {
-        while (l->curChar != '\n' && l->curChar >= 0) {
-          nextChar(l);
-        }
+        jumpTo(l, scanUntil(l->source, l->pos - 1, l->sourceLen, '\n',
+                            &l->line));
         // Now the character for the next loop is the first one of
         // the next line
         goto NO_TOKEN;
       } else if (l->peekChar == '*') {
-        nextChar(l);
-        while ((l->peekChar != '/' || l->curChar != '*') && l->peekChar >= 0) {
-          nextChar(l);
+        // Find the "*/", starting from the '*' that opened the comment
+        int end = l->pos - 1;
+        while (true) {
+          end = scanUntil(l->source, end, l->sourceLen, '*', &l->line);
+          if (end + 1 >= l->sourceLen || l->source[end + 1] == '/') {
+            break;
+          }
+          ++end;
         }
         // Now the character for the next loop is the one right after the
         // comment
-        nextChar(l);
-        nextChar(l);
+        jumpTo(l, end + 2);
         goto NO_TOKEN;
       } else {
         token = NEW_TOKEN(T_DIV);
@@ -221,12 +340,7 @@ void lex(Lexer *l) {
 
       // Character
     case '\'':
-      // Get length of the char
-      dynLen = 1;
-
-      // Get the buffer ready
-      memset(strBuff, 0, STR_BUFF_SIZE);
-      strBuff[0] = '\'';
+      start = l->pos - 2;
       nextChar(l);
 
       switch (l->curChar) {
@@ -237,9 +351,7 @@ void lex(Lexer *l) {
       case '\r':
         throwLexerError(l, "No return in character", '\r');
       case '\\':
-        strBuff[dynLen] = l->curChar;
         nextChar(l);
-        ++dynLen;
 
         switch (l->curChar) {
         case '\n':
@@ -247,97 +359,72 @@ void lex(Lexer *l) {
         case '\r':
           throwLexerError(l, "No return in character", '\r');
         default:
-          strBuff[dynLen] = l->curChar;
           nextChar(l);
-          ++dynLen;
         }
         break;
 
       default:
-        strBuff[dynLen] = l->curChar;
         nextChar(l);
-        ++dynLen;
       }
 
       if (l->curChar != '\'') {
         throwLexerError(l, "End of character literal", l->curChar);
       }
 
-      strBuff[dynLen] = '\'';
-      ++dynLen;
-
-      // Register new string, adding to token
       // Save the token
-      token = (Token){getString(l->sm, strBuff), T_CHAR, l->line};
+      token = (Token){start, l->pos - 1 - start, T_CHAR, l->line};
       break;
 
     // String
     case '"':
-      // Get length of the string
-      dynLen = 1;
-
-      // Get the buffer ready
-      memset(strBuff, 0, STR_BUFF_SIZE);
-      strBuff[0] = l->curChar;
-      nextChar(l);
+      // Find the closing quote
+      start = l->pos - 2;
+      end = start + 1;
+      while (true) {
+        end = scanString(l->source, end, l->sourceLen);
+
+        // End of source? Bytes past ASCII read as EOF too
+        if (end >= l->sourceLen || l->source[end] < 0) {
+          throwLexerError(l, "More source for string", 0);
+        }
 
-      // Backslash?
-      escaped = false;
+        if (l->source[end] == '"') {
+          break;
+        }
 
-      // Copy string text
-      while (!(l->curChar == '\"' && !escaped) && dynLen < STR_BUFF_SIZE) {
-        escaped = false;
+        // A quote straight after a backslash doesn't end the string
+        if (l->source[end] == '\\') {
+          ++end;
+          if (end < l->sourceLen && l->source[end] == '"') {
+            ++end;
+          }
+          continue;
+        }
 
         // Invalid characters in string
-        switch (l->curChar) {
-        case '\n':
+        jumpTo(l, end);
+        if (l->curChar == '\n') {
           throwLexerError(l, "No newline in string", '\n');
-        case '\r':
-          throwLexerError(l, "No return in string", '\r');
-        case '\\':
-          escaped = true;
-        }
-
-        // Copy in next char
-        strBuff[dynLen] = l->curChar;
-        nextChar(l);
-        ++dynLen;
-
-        // End of source?
-        if (l->curChar < 0) {
-          throwLexerError(l, "More source for string", 0);
         }
+        throwLexerError(l, "No return in string", '\r');
       }
 
-      strBuff[dynLen] = l->curChar;
-      ++dynLen;
+      jumpTo(l, end);
 
       // Save the token
-      token = (Token){getString(l->sm, strBuff), T_STRING, l->line};
+      token = (Token){start, end + 1 - start, T_STRING, l->line};
       break;
 
     default:
       // Number
       if (IS_DIGIT(l->curChar)) {
-        // Get length of the number
-        dynLen = 1;
+        start = l->pos - 2;
 
-        // Get the buffer ready
-        memset(strBuff, 0, STR_BUFF_SIZE);
-        strBuff[0] = l->curChar;
-
-        // Get length of number
+        // Get length of number, underscores are left in the text for the
+        // parser to drop
         bool isFloat = false;
-        while (VALID_NUM_CHAR(l->peekChar) && dynLen < STR_BUFF_SIZE) {
-          // Don't add underscores to final string
-          if (l->curChar == '_') {
-            nextChar(l);
-            continue;
-          }
-          // Copy in next char
+        while (VALID_NUM_CHAR(l->peekChar)) {
           nextChar(l);
-          strBuff[dynLen] = l->curChar;
-          ++dynLen;
 
           if (l->curChar == '.') {
             if (isFloat) {
@@ -347,80 +434,40 @@ void lex(Lexer *l) {
           }
         }
 
-        if (strBuff[dynLen - 1] == '.') {
+        if (l->curChar == '.') {
           throwLexerError(l, "Digits after decimal", '.');
         }
 
         // Save the token
-        if (isFloat) {
-          token = (Token){getString(l->sm, strBuff), T_FLOAT, l->line};
-        } else {
-          token = (Token){getString(l->sm, strBuff), T_INT, l->line};
-        }
+        token = (Token){start, l->pos - 1 - start, isFloat ? T_FLOAT : T_INT,
+                        l->line};
       }
 
       // Keywords & Identifier
       else if (IS_ALPHA(l->curChar)) {
-        // Get length of the identifier
-        dynLen = 1;
-
-        // Get the buffer ready
-        memset(strBuff, 0, STR_BUFF_SIZE);
-        strBuff[0] = l->curChar;
-
-        // Get length of word
-        while (VALID_IDENT_CHAR(l->peekChar) && dynLen < STR_BUFF_SIZE) {
-          // Copy in next char
-          nextChar(l);
-          strBuff[dynLen] = l->curChar;
-          ++dynLen;
+        // Get length of the identifier, hashing it on the way. The same hash
+        // is used for finding keywords and for interning
+        start = l->pos - 2;
+        char *text = l->source + start;
+        unsigned int hash = HASH_STEP(HASH_INIT, text[0]);
+        int end = start + 1;
+        while (end < l->sourceLen && VALID_IDENT_CHAR(l->source[end])) {
+          hash = HASH_STEP(hash, l->source[end]);
+          ++end;
         }
+        int len = end - start;
+        jumpTo(l, end - 1);
 
         // Save the token
         // NOTE: All of these keywords are known ahead of time, therefore no
         // dynamic allocation is needed
-        if (cmpStr(strBuff, "break")) {
-          token = NEW_TOKEN(T_BREAK);
-        } else if (cmpStr(strBuff, "call")) {
-          token = NEW_TOKEN(T_CALL);
-        } else if (cmpStr(strBuff, "case")) {
-          token = NEW_TOKEN(T_CASE);
-        } else if (cmpStr(strBuff, "const")) {
-          token = NEW_TOKEN(T_CONST);
-        } else if (cmpStr(strBuff, "continue")) {
-          token = NEW_TOKEN(T_CONTINUE);
-        } else if (cmpStr(strBuff, "default")) {
-          token = NEW_TOKEN(T_DEFAULT);
-        } else if (cmpStr(strBuff, "elif")) {
-          token = NEW_TOKEN(T_ELIF);
-        } else if (cmpStr(strBuff, "else")) {
-          token = NEW_TOKEN(T_ELSE);
-        } else if (cmpStr(strBuff, "enum")) {
-          token = NEW_TOKEN(T_ENUM);
-        } else if (cmpStr(strBuff, "for")) {
-          token = NEW_TOKEN(T_FOR);
-        } else if (cmpStr(strBuff, "fun")) {
-          token = NEW_TOKEN(T_FUN);
-        } else if (cmpStr(strBuff, "if")) {
-          token = NEW_TOKEN(T_IF);
-        } else if (cmpStr(strBuff, "let")) {
-          token = NEW_TOKEN(T_LET);
-        } else if (cmpStr(strBuff, "make")) {
-          token = NEW_TOKEN(T_MAKE);
-        } else if (cmpStr(strBuff, "new")) {
-          token = NEW_TOKEN(T_NEW);
-        } else if (cmpStr(strBuff, "return")) {
-          token = NEW_TOKEN(T_RETURN);
-        } else if (cmpStr(strBuff, "struct")) {
-          token = NEW_TOKEN(T_STRUCT);
-        } else if (cmpStr(strBuff, "switch")) {
-          token = NEW_TOKEN(T_SWITCH);
-        } else if (cmpStr(strBuff, "true")) {
-          token = NEW_TOKEN(T_TRUE);
-        } else if (cmpStr(strBuff, "false")) {
-          token = NEW_TOKEN(T_FALSE);
+        const Keyword *kw =
+            keywords + ((hash >> KEYWORD_SHIFT) & (KEYWORD_SLOTS - 1));
+
+        if (kw->len == len && !memcmp(kw->word, text, len)) {
+          token = NEW_TOKEN(kw->kind);
         } else {
-          token = (Token){getString(l->sm, strBuff), T_IDENTIFIER, l->line};
+          token = (Token){start, len, T_IDENTIFIER, l->line, hash};
         }
       }
 
@@ -430,16 +477,15 @@ void lex(Lexer *l) {
       }
     }
 
-    // Add that token to the end of the list
-    if (TokenListAppend(&l->out, token)) {
-      panic("Couldn't append to token list.");
-    }
-
-    // Clear the token
-    token = ZERO_TOKEN;
+    // Move past this token, ready for the next call
+    nextChar(l);
+    STAT_COUNT(COUNT_TOKENS, 1)
+    return token;
 
   NO_TOKEN:
 
     nextChar(l);
   }
+
+  return ZERO_TOKEN;
 }
@@ -2,22 +2,30 @@
 
 #include "StringManager.h"
 #include "Token.h"
-#include "list.h"
 
-#include <stdio.h>
+#include <corecrt.h>
 
 typedef struct Lexer {
   char *sourceName;
-  FILE *source;
+
+  // The whole source file, read in one go, pos is the next byte to read
+  char *source;
+  int sourceLen;
+  int pos;
+
   char curChar;
   char peekChar;
   int line;
-  TokenList out;
   StringManager *sm;
 } Lexer;
 
-void lexerInit(Lexer *l, char sourceName[], FILE *source, StringManager *sm);
+// Reads in the source file, returns non-zero if it couldn't be read
+errno_t lexerInit(Lexer *l, char sourceName[], StringManager *sm);
+
+// Frees the source. Tokens lexed from it are invalid after this, their text
+// is a slice of the source
+void lexerDestroy(Lexer *l);
 
-// Returns the tokens of the source in the lexer, the resulting list must be
-// destroyed
-void lex(Lexer *l);
+// Returns the next token in the source, or a ZERO_TOKEN once the source has run
+// out
+Token lexToken(Lexer *l);
@@ -1,96 +1,39 @@
 #include "Node.h"
 #include "CharList.h"
 #include "Panic.h"
+#include "Stats.h"
+
+#include <string.h>
 
 Node newNode(NodeCode kind, char *data, int line, char *sourceName) {
   NodeList children;
 
-  if (NodeListInit(&children, 1)) {
+  // Leaves never allocate, see list.h
+  if (NodeListInit(&children, 0)) {
     panic("Couldn't create node (failed to init list)");
   }
 
+  STAT_NODE(kind)
   return (Node){kind, children, data, line, sourceName};
 }
 
-errno_t NodeListInit(NodeList *l, int initialSize) {
-  if (initialSize < 0) {
-    return 1;
-  }
-  l->len = 0;
-  l->cap = initialSize;
-  l->p = (Node *)calloc(initialSize, sizeof(Node));
-  if (l->p == ((void *)0)) {
-    return 1;
-  }
-  return 0;
-}
-void NodeListDestroy(NodeList *l) { free(l->p); }
-errno_t NodeListAppend(NodeList *l, Node item) {
-  if (l->len == l->cap) {
-    l->cap *= 2;
-    Node *newP = (Node *)calloc(l->cap, sizeof(Node));
-    if (newP == ((void *)0)) {
-      return 1;
-    }
-    for (int i = 0; i < l->len; ++i) {
-      newP[i] = l->p[i];
-    }
-    free(l->p);
-    l->p = newP;
-  }
-  l->p[l->len] = item;
-  ++l->len;
-  return 0;
-}
-NodeList NodeListCopy(NodeList *src) {
-  NodeList dest;
-  dest.len = src->len;
-  dest.cap = src->len;
-  dest.p = (Node *)calloc(dest.cap, sizeof(Node));
-  for (int i = 0; i < src->len; ++i) {
-    dest.p[i] = src->p[i];
-  }
-  return dest;
-}
-errno_t NodeListRemoveAt(NodeList *l, int index) {
-  if (index < 0 || index >= l->len) {
-    return 1;
-  }
-  --l->len;
-  for (int i = index; i < l->len; ++i) {
-    l->p[i] = l->p[i + 1];
-  }
-  return 0;
-}
-errno_t NodeListInsertAt(NodeList *l, Node item, int index) {
-  if (index < 0 || index > l->len) {
-    return 1;
-  }
-  if (NodeListAppend(l, l->p[l->len - 1])) {
-    return 1;
-  }
-  for (int i = l->len - 2; i > index; --i) {
-    l->p[i] = l->p[i - 1];
-  }
-  l->p[index] = item;
-  return 0;
-}
+thread_local Arena *nodeArena = NULL;
 
-// Recursively frees all children
-void nodeDestroy(Node *n) {
-  // Free all children
-  for (int i = 0; i < n->children.len; ++i) {
-    nodeDestroy(n->children.p + i);
-  }
+// The arena counts its own blocks under SUB_NODES
+#define NODE_LIST_GROW(newP, p, oldBytes, newBytes, SUBSYSTEM)                 \
+  newP = arenaGrow(nodeArena, (p), (oldBytes), (newBytes));
 
-  // Free the list holding the children
-  NodeListDestroy(&n->children);
-}
+#define NODE_LIST_RELEASE(p, bytes, SUBSYSTEM)
+
+NEW_LIST_TYPE_IMPL_FROM(Node, Node, SUB_NODES, NODE_LIST_GROW,
+                        NODE_LIST_RELEASE)
 
 char *nodeCodeString(NodeCode nc) {
   switch (nc) {
   case N_ILLEGAL:
     return "N_ILLEGAL";
+  case N_EMPTY:
+    return "N_EMPTY";
 
     // Structures
   case N_PROGRAM:
@@ -150,61 +93,17 @@ char *nodeCodeString(NodeCode nc) {
   case N_ACCESS:
     return "N_ACCESS";
 
-    // Keywords
-  case N_BREAK:
-    return "N_BREAK";
-  case N_CALL:
-    return "N_CALL";
-  case N_CASE:
-    return "N_CASE";
-  case N_CONST:
-    return "N_CONST";
-  case N_CONTINUE:
-    return "N_CONTINUE";
-  case N_DEFAULT:
-    return "N_DEFAULT";
-  case N_ELIF:
-    return "N_ELIF";
-  case N_ELSE:
-    return "N_ELSE";
-  case N_ENUM:
-    return "N_ENUM";
-  case N_FOR:
-    return "N_FOR";
-  case N_FUN:
-    return "N_FUN";
-  case N_IF:
-    return "N_IF";
-  case N_LET:
-    return "N_LET";
-  case N_MAKE:
-    return "N_MAKE";
-  case N_NEW:
-    return "N_NEW";
-  case N_RETURN:
-    return "N_RETURN";
-  case N_STRUCT:
-    return "N_STRUCT";
-  case N_SWITCH:
-    return "N_SWITCH";
+    // Keywords that are values
   case N_TRUE:
     return "N_TRUE";
   case N_FALSE:
     return "N_FALSE";
 
-    // Various symbols
+    // Accessors
   case N_ACCESSOR:
     return "N_ACCESSOR";
   case N_P_ACCESSOR:
     return "N_P_ACCESSOR";
-  case N_ASSIGN:
-    return "N_ASSIGN";
-  case N_COLON:
-    return "N_COLON";
-  case N_SEMICOLON:
-    return "N_SEMICOLON";
-  case N_SEP:
-    return "N_SEP";
 
     // Operators
   case N_ADD:
@@ -256,20 +155,6 @@ char *nodeCodeString(NodeCode nc) {
   case N_REF:
     return "N_REF";
 
-    // Paired symbols
-  case N_L_BLOCK:
-    return "N_L_BLOCK";
-  case N_R_BLOCK:
-    return "N_R_BLOCK";
-  case N_L_SQUIRLY:
-    return "N_L_SQUIRLY";
-  case N_R_SQUIRLY:
-    return "N_R_SQUIRLY";
-  case N_L_PAREN:
-    return "N_L_PAREN";
-  case N_R_PAREN:
-    return "N_R_PAREN";
-
     // Values
   case N_CHAR:
     return "N_CHAR";
@@ -297,39 +182,18 @@ errno_t stringRec(Node *n, CharList *out, int indent) {
 
   // Node code
   char *code = nodeCodeString(n->kind);
-  for (int i = 0; code[i]; ++i) {
-    if (CharListAppend(out, code[i])) {
-      return 1;
-    }
-  }
-
-  if (CharListAppend(out, ':')) {
+  if (CharListAppendN(out, code, strlen(code))) {
     return 1;
   }
-  if (CharListAppend(out, ' ')) {
+
+  if (CharListAppendN(out, ": ", 2)) {
     return 1;
   }
 
   // Data
-  if (n->data == NULL) {
-    if (CharListAppend(out, 'N')) {
-      return 1;
-    }
-    if (CharListAppend(out, 'U')) {
-      return 1;
-    }
-    if (CharListAppend(out, 'L')) {
-      return 1;
-    }
-    if (CharListAppend(out, 'L')) {
-      return 1;
-    }
-  } else {
-    for (int i = 0; n->data[i]; ++i) {
-      if (CharListAppend(out, n->data[i])) {
-        return 1;
-      }
-    }
+  char *data = n->data == NULL ? "NULL" : n->data;
+  if (CharListAppendN(out, data, strlen(data))) {
+    return 1;
   }
 
   if (CharListAppend(out, '\n')) {
@@ -353,54 +217,13 @@ char *nodeString(Node *n) {
     panic("Couldn't string node (init issue)");
   }
 
-  // Node code
-  NodeCode kind = n->kind;
-
-  char *code = nodeCodeString(kind);
-  for (int i = 0; code[i]; ++i) {
-    if (CharListAppend(&out, code[i])) {
-      panic("Couldn't string node (append issue)");
-    }
+  if (stringRec(n, &out, 0)) {
+    panic("Couldn't string node (Recursive string issue)");
   }
 
-  if (CharListAppend(&out, ':')) {
+  if (CharListAppend(&out, 0)) {
     panic("Couldn't string node (append issue)");
   }
-  if (CharListAppend(&out, ' ')) {
-    panic("Couldn't string node (append issue)");
-  }
-
-  // Data
-  if (n->data == NULL) {
-    if (CharListAppend(&out, 'N')) {
-      panic("Couldn't string node (append issue)");
-    }
-    if (CharListAppend(&out, 'U')) {
-      panic("Couldn't string node (append issue)");
-    }
-    if (CharListAppend(&out, 'L')) {
-      panic("Couldn't string node (append issue)");
-    }
-    if (CharListAppend(&out, 'L')) {
-      panic("Couldn't string node (append issue)");
-    }
-  } else {
-    for (int i = 0; n->data[i]; ++i) {
-      if (CharListAppend(&out, n->data[i])) {
-        panic("Couldn't string node (append issue)");
-      }
-    }
-  }
-
-  if (CharListAppend(&out, '\n')) {
-    panic("Couldn't string node (append issue)");
-  }
-
-  for (int i = 0; i < n->children.len; ++i) {
-    if (stringRec((n->children.p) + i, &out, 1)) {
-      panic("Couldn't string node (Recursive string issue)");
-    }
-  }
 
   return out.p;
 }
@@ -2,10 +2,14 @@
 
 #define ZERO_NODE (Node){N_ILLEGAL, ZERO_LIST, NULL, 0}
 
+#include "Arena.h"
 #include "list.h"
 
+#include <threads.h>
+
 typedef enum NodeCode {
   N_ILLEGAL,
+  N_EMPTY, // An optional part that was left out, see below
 
   // Structures
   N_PROGRAM,
@@ -37,35 +41,13 @@ typedef enum NodeCode {
   N_DEFAULT_BLOCK,
   N_ACCESS,
 
-  // Keywords
-  N_BREAK,
-  N_CALL,
-  N_CASE,
-  N_CONST,
-  N_CONTINUE,
-  N_DEFAULT,
-  N_ELIF,
-  N_ELSE,
-  N_ENUM,
-  N_FOR,
-  N_FUN,
-  N_IF,
-  N_LET,
-  N_MAKE,
-  N_NEW,
-  N_RETURN,
-  N_STRUCT,
-  N_SWITCH,
+  // Keywords that are values
   N_TRUE,
   N_FALSE,
 
-  // Various symbols
+  // Accessors
   N_ACCESSOR,
   N_P_ACCESSOR,
-  N_ASSIGN,
-  N_COLON,
-  N_SEMICOLON,
-  N_SEP,
 
   // Operators
   N_ADD,
@@ -94,14 +76,6 @@ typedef enum NodeCode {
   N_NOT,
   N_REF,
 
-  // Paired symbols
-  N_L_BLOCK,   // [
-  N_R_BLOCK,   // ]
-  N_L_SQUIRLY, // {
-  N_R_SQUIRLY, // }
-  N_L_PAREN,   // (
-  N_R_PAREN,   // )
-
   // Values
   N_CHAR,
   N_FLOAT,
@@ -110,6 +84,94 @@ typedef enum NodeCode {
   N_STRING,
 } NodeCode;
 
+// Punctuation and keywords aren't kept in the tree, each node's children are
+// only the parts that mean something, in this order. An optional part that
+// couldn't be told apart from what's after it by its kind is always there,
+// as an N_EMPTY node when it's left out
+//
+// N_ENUM_DEF        name, then each constant
+// N_STRUCT_DEF      name, then each prop's type and name
+// N_FUNC_DEF        name, return type or N_EMPTY, block, then each param's
+//                   type and name
+// N_COMPLEX_TYPE    index or deref, then identifier or complex type
+// N_BLOCK           each statement
+// N_INDEX           expression
+// N_EXPRESSION      value, then each operator and value
+// N_UNARY_VALUE     unary or index, then expression or unary value
+// N_BRACKETED_VALUE expression
+// N_LONE_CALL       func call
+// N_MAKE_ARRAY      each expression
+// N_FUNC_CALL       name, then each argument
+// N_STRUCT_NEW      name, then each expression
+// N_VAR_DEC         assignment or new assignment
+// N_NEW_ASSIGNMENT  type, name, expression
+// N_CREMENT         inc or dec, identifier or access, maybe an index
+// N_ASSIGNMENT      crement, or identifier or access, maybe an index, then
+//                   expression
+// N_IF_BLOCK        condition and block for the if and each elif, then the
+//                   else's block if there is one
+// N_FOR_LOOP        assignment or new assignment, condition and assignment,
+//                   each maybe N_EMPTY, then block
+// N_RET_STATE       expression if there is one
+// N_SWITCH_STATE    expression, then each case block, then maybe a default
+//                   block
+// N_CASE_BLOCK      expression, then each statement
+// N_DEFAULT_BLOCK   each statement
+// N_ACCESS          identifier, accessor or p accessor, then identifier or
+//                   access
+
+// Where the fixed parts are, for the nodes that have more than one
+#define DEF_NAME 0 // Enum, struct and function definitions
+#define DEF_BODY 1 // Enum constants and struct props
+
+#define FUNC_DEF_RET 1
+#define FUNC_DEF_BLOCK 2
+#define FUNC_DEF_PARAMS 3
+
+#define CALL_NAME 0 // Function calls and struct news
+#define CALL_ARGS 1
+
+#define NEW_ASSIGNMENT_TYPE 0
+#define NEW_ASSIGNMENT_NAME 1
+#define NEW_ASSIGNMENT_EXPR 2
+
+#define FOR_INIT 0
+#define FOR_COND 1
+#define FOR_STEP 2
+#define FOR_BLOCK 3
+
+#define SWITCH_EXPR 0
+#define SWITCH_CASES 1
+
+#define CASE_EXPR 0
+#define CASE_STATEMENTS 1
+
+#define EXPR_LEFT 0 // Then each operator and the value after it
+#define EXPR_OP 1
+#define EXPR_RIGHT 2
+#define EXPR_STEP 2
+
+#define IF_COND 0 // Then each elif's, then maybe the else's block
+#define IF_THEN 1
+#define IF_STEP 2
+
+#define UNARY_OP 0 // Unary or index
+#define UNARY_OPERAND 1
+
+#define COMPLEX_TYPE_MOD 0 // Index or deref
+#define COMPLEX_TYPE_INNER 1
+
+#define CREMENT_OP 0
+#define CREMENT_TARGET 1
+#define CREMENT_INDEX 2 // Only if the target is indexed
+
+#define ASSIGN_TARGET 0 // Crement, identifier or access
+#define ASSIGN_INDEX 1  // Only if the target is indexed, the expression is last
+
+#define ACCESS_BASE 0
+#define ACCESS_OP 1 // Accessor or p accessor
+#define ACCESS_MEMBER 2
+
 typedef struct Node Node;
 
 NEW_LIST_TYPE_HEADER(Node, Node)
@@ -122,7 +184,9 @@ struct Node {
   char *sourceName;
 };
 
-void nodeDestroy(Node *t);
+// Where newNode and child lists get their memory on this thread. Nodes are
+// never freed one by one, a tree goes when the arena it was built in does
+extern thread_local Arena *nodeArena;
 
 char *nodeCodeString(NodeCode tc);
 
@@ -0,0 +1,110 @@
+#include "NodeEdits.h"
+#include "Panic.h"
+#include "Stats.h"
+
+#include <string.h>
+
+NEW_LIST_TYPE_IMPL(NodeEdit, NodeEdit, SUB_NODES)
+
+void nodeEditsInit(NodeEdits *e, NodeList *list) {
+  e->list = list;
+
+  // Most batches stay empty, which doesn't allocate
+  if (NodeEditListInit(&e->edits, 0)) {
+    panic("Couldn't init node edits");
+  }
+}
+
+void nodeEditsDestroy(NodeEdits *e) { NodeEditListDestroy(&e->edits); }
+
+void nodeEditsSplice(NodeEdits *e, int index, int removeCount, Node *items,
+                     int itemCount) {
+  if (index < 0 || removeCount < 0 || itemCount < 0 ||
+      index + removeCount > e->list->len) {
+    panic("Node edit out of range");
+  }
+
+  if (NodeEditListAppend(&e->edits,
+                         (NodeEdit){index, removeCount, items, itemCount})) {
+    panic("Couldn't append to node edits");
+  }
+}
+
+void nodeEditsRemove(NodeEdits *e, int index, int n) {
+  nodeEditsSplice(e, index, n, NULL, 0);
+}
+
+void nodeEditsInsert(NodeEdits *e, int index, Node *items, int n) {
+  nodeEditsSplice(e, index, 0, items, n);
+}
+
+// Passes walk their lists forwards, so edits nearly always come in order
+// already, and an insertion sort keeps ones at the same index in order
+void sortNodeEdits(NodeEditList *edits) {
+  for (int i = 1; i < edits->len; ++i) {
+    NodeEdit edit = edits->p[i];
+
+    int j = i;
+    while (j > 0 && edits->p[j - 1].index > edit.index) {
+      edits->p[j] = edits->p[j - 1];
+      --j;
+    }
+    edits->p[j] = edit;
+  }
+}
+
+void nodeEditsApply(NodeEdits *e) {
+  if (e->edits.len == 0) {
+    return;
+  }
+
+  sortNodeEdits(&e->edits);
+
+  int inserted = 0;
+  for (int i = 0; i < e->edits.len; ++i) {
+    inserted += e->edits.p[i].itemCount;
+  }
+
+  // Without insertions nothing is written ahead of what's been read, so the
+  // list can be compacted where it is. Otherwise it's rebuilt somewhere with
+  // room, since the items could be anywhere, even in the list
+  NodeList *l = e->list;
+  NodeList out = *l;
+  if (inserted > 0) {
+    if (NodeListInit(&out, 0) || NodeListReserve(&out, l->len + inserted)) {
+      panic("Couldn't apply node edits");
+    }
+  }
+
+  int read = 0, write = 0;
+  for (int i = 0; i < e->edits.len; ++i) {
+    NodeEdit *edit = e->edits.p + i;
+
+    // What's untouched before the edit
+    if (edit->index > read) {
+      memmove(out.p + write, l->p + read, (edit->index - read) * sizeof(Node));
+      write += edit->index - read;
+      read = edit->index;
+    }
+
+    if (edit->itemCount > 0) {
+      memcpy(out.p + write, edit->items, edit->itemCount * sizeof(Node));
+      write += edit->itemCount;
+    }
+
+    if (edit->index + edit->removeCount > read) {
+      read = edit->index + edit->removeCount;
+    }
+  }
+
+  memmove(out.p + write, l->p + read, (l->len - read) * sizeof(Node));
+  write += l->len - read;
+
+  if (inserted > 0) {
+    NodeListDestroy(l);
+  }
+  out.len = write;
+  *l = out;
+
+  NodeEditListClear(&e->edits);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Node.h"
+#include "list.h"
+
+// Batches up changes to a node list so a pass can make as many as it likes
+// while walking the list, then have them all done in one go. Until the batch
+// is applied the list doesn't change, so every index in it means what it did
+// when the pass started, and edits are given in those indexes.
+//
+// Removing from or inserting into a list one node at a time shifts everything
+// after it each time, applying a batch moves each node once
+
+typedef struct NodeEdit {
+  int index;       // Before any of the batch's edits
+  int removeCount; // How many to remove from index
+  Node *items;     // Take the place of the removed ones, in order
+  int itemCount;
+} NodeEdit;
+
+NEW_LIST_TYPE_HEADER(NodeEdit, NodeEdit)
+
+typedef struct NodeEdits {
+  NodeList *list;
+  NodeEditList edits;
+} NodeEdits;
+
+void nodeEditsInit(NodeEdits *e, NodeList *list);
+
+void nodeEditsDestroy(NodeEdits *e);
+
+// Replaces removeCount nodes from index with itemCount items. The items aren't
+// copied until the batch is applied, they have to stay put until then.
+// Removals that overlap only remove each node once, edits at the same index
+// happen in the order they were made
+void nodeEditsSplice(NodeEdits *e, int index, int removeCount, Node *items,
+                     int itemCount);
+
+void nodeEditsRemove(NodeEdits *e, int index, int n);
+
+void nodeEditsInsert(NodeEdits *e, int index, Node *items, int n);
+
+// Makes every edit in the batch, leaving it empty to be used again
+void nodeEditsApply(NodeEdits *e);
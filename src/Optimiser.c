@@ -1,6 +1,9 @@
 #include "Optimiser.h"
 #include "Node.h"
+#include "NodeEdits.h"
 #include "Panic.h"
+#include "Stats.h"
+#include "Trace.h"
 #include "list.h"
 
 #include <stdbool.h>
@@ -24,7 +27,7 @@ typedef struct Variable {
   int decIndex;
 } Variable;
 
-NEW_LIST_TYPE(Variable, Var)
+NEW_LIST_TYPE(Variable, Var, SUB_OPTIMISER)
 
 #define SET_VAR_CHANGED                                                        \
   for (int k = 0; k < vars->len; ++k) {                                        \
@@ -34,12 +37,17 @@ NEW_LIST_TYPE(Variable, Var)
     }                                                                          \
   }
 
-#define NODE_LIST_REMOVE(list, index)                                          \
-  if (NodeListRemoveAt((list), (index))) {                                     \
+#define NODE_LIST_REMOVE_N(list, index, n)                                     \
+  if (NodeListRemoveN((list), (index), (n))) {                                 \
     panic("Couldn't remove from nodelist\n");                                  \
   }
 
-void scrubVariable(Optimiser *o, char *name, Node *n, Node *parent, int index) {
+void scrubChildren(Optimiser *o, char *name, Node *n, NodeEdits *edits);
+
+// Removes assignments to name from n and everything in it. n is at index in
+// the list edits is batching
+void scrubVariable(Optimiser *o, char *name, Node *n, NodeEdits *edits,
+                   int index) {
   Node *assignment;
   Node *ident;
   char *other;
@@ -48,91 +56,94 @@ void scrubVariable(Optimiser *o, char *name, Node *n, Node *parent, int index) {
   case N_VAR_DEC:
     assignment = n->children.p;
 
-    printf("Found var dec %i\n", assignment->line);
+    LOG("Found var dec %i\n", assignment->line);
 
     // Don't even look at new assignment
     if (assignment->kind == N_ASSIGNMENT) {
-      if (assignment->children.p[0].kind == N_CREMENT) {
-        assignment = assignment->children.p;
-        ident = assignment->children.p + 1;
+      if (assignment->children.p[ASSIGN_TARGET].kind == N_CREMENT) {
+        assignment = assignment->children.p + ASSIGN_TARGET;
+        ident = assignment->children.p + CREMENT_TARGET;
         if (ident->kind == N_ACCESS) {
-          ident = ident->children.p;
+          ident = ident->children.p + ACCESS_BASE;
         }
         other = ident->data;
 
-        if (cmpStr(name, other)) {
-          NODE_LIST_REMOVE(&parent->children, index)
+        if (SAME_SYMBOL(name, other)) {
+          nodeEditsRemove(edits, index, 1);
         }
       } else {
 
-        printf("Assignmnent %i\n", assignment->line);
+        LOG("Assignmnent %i\n", assignment->line);
 
-        ident = assignment->children.p;
+        ident = assignment->children.p + ASSIGN_TARGET;
         if (ident->kind == N_ACCESS) {
-          ident = ident->children.p;
+          ident = ident->children.p + ACCESS_BASE;
         }
         other = ident->data;
 
-        if (cmpStr(name, other)) {
-          NODE_LIST_REMOVE(&parent->children, index)
+        if (SAME_SYMBOL(name, other)) {
+          nodeEditsRemove(edits, index, 1);
         }
       }
     }
     break;
 
+  default:
+    // Whatever's removed from inside n goes in one batch
+    NodeEdits inner;
+    nodeEditsInit(&inner, &n->children);
+    scrubChildren(o, name, n, &inner);
+    nodeEditsApply(&inner);
+    nodeEditsDestroy(&inner);
+    break;
+  }
+}
+
+// Scrubs each statement in n, removing them through edits, which batches
+// n's children
+void scrubChildren(Optimiser *o, char *name, Node *n, NodeEdits *edits) {
+  switch (n->kind) {
   case N_FOR_LOOP:
-    if (n->children.p[2].kind == N_ASSIGNMENT) {
-      scrubVariable(o, name, n->children.p + 2, n, 2);
+    if (n->children.p[FOR_INIT].kind == N_ASSIGNMENT) {
+      scrubVariable(o, name, n->children.p + FOR_INIT, edits, FOR_INIT);
     }
 
-    if (n->children.p[n->children.len - 3].kind == N_ASSIGNMENT) {
-      scrubVariable(o, name, n->children.p + n->children.len - 3, n,
-                    n->children.len - 3);
+    if (n->children.p[FOR_STEP].kind == N_ASSIGNMENT) {
+      scrubVariable(o, name, n->children.p + FOR_STEP, edits, FOR_STEP);
     }
 
-    scrubVariable(o, name, n->children.p + n->children.len - 1, n,
-                  n->children.len - 1);
+    scrubVariable(o, name, n->children.p + FOR_BLOCK, edits, FOR_BLOCK);
     break;
 
   case N_IF_BLOCK:
-    scrubVariable(o, name, n->children.p + 4, n, 4);
-
-    int i = 5;
-
-    while (i < n->children.len) {
-      if (n->children.p[i].kind == N_ELIF) {
-        scrubVariable(o, name, n->children.p + i + 4, n, i + 4);
-      } else {
-        scrubVariable(o, name, n->children.p + i + 1, n, i + 1);
-        break;
-      }
+    // Each block comes after its condition, the else's block is last
+    for (int i = IF_THEN; i < n->children.len; i += IF_STEP) {
+      scrubVariable(o, name, n->children.p + i, edits, i);
+    }
 
-      i += 5;
+    if (n->children.len % 2 == 1) {
+      scrubVariable(o, name, n->children.p + n->children.len - 1, edits,
+                    n->children.len - 1);
     }
     break;
 
   case N_SWITCH_STATE:
-    for (int i = 5; i < n->children.len - 1; ++i) {
-      scrubVariable(o, name, n->children.p + i, n, i);
+    for (int i = SWITCH_CASES; i < n->children.len; ++i) {
+      scrubVariable(o, name, n->children.p + i, edits, i);
     }
 
     break;
 
   case N_CASE_BLOCK:
-    for (int i = 3; i < n->children.len; ++i) {
-      scrubVariable(o, name, n->children.p + i, n, i);
+    for (int i = CASE_STATEMENTS; i < n->children.len; ++i) {
+      scrubVariable(o, name, n->children.p + i, edits, i);
     }
     break;
 
   case N_DEFAULT_BLOCK:
-    for (int i = 2; i < n->children.len; ++i) {
-      scrubVariable(o, name, n->children.p + i, n, i);
-    }
-    break;
-
   case N_BLOCK:
-    for (int i = 1; i < n->children.len - 1; ++i) {
-      scrubVariable(o, name, n->children.p + i, n, i);
+    for (int i = 0; i < n->children.len; ++i) {
+      scrubVariable(o, name, n->children.p + i, edits, i);
     }
     break;
 
@@ -143,11 +154,23 @@ void scrubVariable(Optimiser *o, char *name, Node *n, Node *parent, int index) {
 }
 
 void removeVariable(Optimiser *o, Variable v) {
-  printf("Removing variable %s\n", v.name);
-  scrubVariable(o, v.name, v.decBlock, NULL, 0);
-
-  // Remove the original declaration
-  NODE_LIST_REMOVE(&v.decBlock->children, v.decIndex)
+  LOG("Removing variable %s\n", v.name);
+
+  // The declaration goes in the same batch as the assignments next to it
+  NodeEdits edits;
+  nodeEditsInit(&edits, &v.decBlock->children);
+
+  // A for loop's init keeps its place, it's only left out
+  Node empty;
+  if (v.decBlock->kind == N_FOR_LOOP) {
+    empty = newNode(N_EMPTY, NULL, v.decBlock->line, v.decBlock->sourceName);
+    nodeEditsSplice(&edits, v.decIndex, 1, &empty, 1);
+  } else {
+    nodeEditsRemove(&edits, v.decIndex, 1);
+  }
+  scrubChildren(o, v.name, v.decBlock, &edits);
+  nodeEditsApply(&edits);
+  nodeEditsDestroy(&edits);
 }
 
 void variableEliminationExpression(Optimiser *o, Node *expr, VarList *vars);
@@ -156,37 +179,39 @@ void variableEliminationValue(Optimiser *o, Node *val, VarList *vars) {
   switch (val->kind) {
   case N_UNARY_VALUE: // If we're actually a unary value, check the actual value
                       // inside
-    if (val->children.p[0].kind == N_INDEX) {
+    if (val->children.p[UNARY_OP].kind == N_INDEX) {
       // Also check inside of the index
-      variableEliminationExpression(o, val->children.p[0].children.p + 1, vars);
+      variableEliminationExpression(o, val->children.p[UNARY_OP].children.p,
+                                    vars);
+    }
+
+    // The operand is either an expression or another unary value
+    if (val->children.p[UNARY_OPERAND].kind == N_EXPRESSION) {
+      variableEliminationExpression(o, val->children.p + UNARY_OPERAND, vars);
+    } else {
+      variableEliminationValue(o, val->children.p + UNARY_OPERAND, vars);
     }
-    variableEliminationValue(o, val->children.p + 1, vars);
     return;
 
   case N_BRACKETED_VALUE:
-    variableEliminationExpression(o, val->children.p + 1, vars);
+    variableEliminationExpression(o, val->children.p, vars);
     return;
 
   case N_FUNC_CALL:
-    for (int i = 3; i < val->children.len - 1; i += 2) {
+  case N_STRUCT_NEW:
+    for (int i = CALL_ARGS; i < val->children.len; ++i) {
       variableEliminationExpression(o, val->children.p + i, vars);
     }
     return;
 
   case N_MAKE_ARRAY:
-    for (int i = 2; i < val->children.len - 1; i += 2) {
-      variableEliminationExpression(o, val->children.p + i, vars);
-    }
-    return;
-
-  case N_STRUCT_NEW:
-    for (int i = 3; i < val->children.len - 1; i += 2) {
+    for (int i = 0; i < val->children.len; ++i) {
       variableEliminationExpression(o, val->children.p + i, vars);
     }
     return;
 
   case N_ACCESS:
-    variableEliminationValue(o, val->children.p, vars);
+    variableEliminationValue(o, val->children.p + ACCESS_BASE, vars);
     return;
 
   case N_IDENTIFIER:
@@ -195,7 +220,7 @@ void variableEliminationValue(Optimiser *o, Node *val, VarList *vars) {
     for (int i = 0; i < vars->len; ++i) {
       Variable *v = vars->p + i;
 
-      if (cmpStr(name, v->name)) {
+      if (SAME_SYMBOL(name, v->name)) {
         v->used = true;
       }
     }
@@ -215,11 +240,11 @@ void variableEliminationExpression(Optimiser *o, Node *expr, VarList *vars) {
   // values
 
   // Check first operand
-  variableEliminationValue(o, expr->children.p, vars);
+  variableEliminationValue(o, expr->children.p + EXPR_LEFT, vars);
 
   // Check second operand (if any)
   if (expr->children.len == 3) {
-    variableEliminationValue(o, expr->children.p + 2, vars);
+    variableEliminationValue(o, expr->children.p + EXPR_RIGHT, vars);
   }
 }
 
@@ -241,20 +266,21 @@ bool variableEliminationStatement(Optimiser *o, Node *state, Node *block, int i,
     if (assignment->kind == N_NEW_ASSIGNMENT) {
       // Check expression
       variableEliminationExpression(
-          o, assignment->children.p + assignment->children.len - 1, vars);
+          o, assignment->children.p + NEW_ASSIGNMENT_EXPR, vars);
 
       // Add new variable
-      v = (Variable){assignment->children.p[2].data, false, block, i};
+      v = (Variable){assignment->children.p[NEW_ASSIGNMENT_NAME].data, false,
+                     block, i};
       if (VarListAppend(vars, v)) {
         panic("Couldn't append to varlist\n");
       }
 
-    } else if (assignment->children.p[0].kind != N_CREMENT) {
+    } else if (assignment->children.p[ASSIGN_TARGET].kind != N_CREMENT) {
       // First check the index if there is one
-      if (assignment->children.p[1].kind == N_INDEX) {
-        index = assignment->children.p + 1;
+      if (assignment->children.p[ASSIGN_INDEX].kind == N_INDEX) {
+        index = assignment->children.p + ASSIGN_INDEX;
 
-        variableEliminationExpression(o, index->children.p + 1, vars);
+        variableEliminationExpression(o, index->children.p, vars);
       }
 
       // Then check the expression
@@ -268,34 +294,33 @@ bool variableEliminationStatement(Optimiser *o, Node *state, Node *block, int i,
   case N_LONE_CALL:
     // Check each arg
     fn = state->children.p;
-    for (j = 3; j < fn->children.len; j += 2) {
+    for (j = CALL_ARGS; j < fn->children.len; ++j) {
       variableEliminationExpression(o, fn->children.p + j, vars);
     }
     break;
 
   case N_FOR_LOOP:
     // Check first assignment, condition, second assignment, and block
-    j = 2;
-    assignment = state->children.p + j;
+    assignment = state->children.p + FOR_INIT;
 
     if (assignment->kind == N_NEW_ASSIGNMENT) {
       // Check expression
       variableEliminationExpression(
-          o, assignment->children.p + assignment->children.len - 1, vars);
+          o, assignment->children.p + NEW_ASSIGNMENT_EXPR, vars);
 
       // Add new variable
-      v = (Variable){assignment->children.p[2].data, false, state, j};
+      v = (Variable){assignment->children.p[NEW_ASSIGNMENT_NAME].data, false,
+                     state, FOR_INIT};
       if (VarListAppend(vars, v)) {
         panic("Couldn't append to varlist\n");
       }
-      j += 2;
     } else if (assignment->kind == N_ASSIGNMENT) {
-      if (assignment->children.p[0].kind != N_CREMENT) {
+      if (assignment->children.p[ASSIGN_TARGET].kind != N_CREMENT) {
         // First check the index if there is one
-        if (assignment->children.p[1].kind == N_INDEX) {
-          index = assignment->children.p + 1;
+        if (assignment->children.p[ASSIGN_INDEX].kind == N_INDEX) {
+          index = assignment->children.p + ASSIGN_INDEX;
 
-          variableEliminationExpression(o, index->children.p + 1, vars);
+          variableEliminationExpression(o, index->children.p, vars);
         }
 
         // Then check the expression
@@ -304,27 +329,21 @@ bool variableEliminationStatement(Optimiser *o, Node *state, Node *block, int i,
       } else { // Crement
                // Do nothing, doesn't count as using the variable
       }
-      j += 2;
-    } else {
-      ++j;
     }
 
-    expr = state->children.p + j;
+    expr = state->children.p + FOR_COND;
     if (expr->kind == N_EXPRESSION) {
       variableEliminationExpression(o, expr, vars);
-      j += 2;
-    } else {
-      ++j;
     }
 
-    assignment = state->children.p + j;
+    assignment = state->children.p + FOR_STEP;
     if (assignment->kind == N_ASSIGNMENT) {
-      if (assignment->children.p[0].kind != N_CREMENT) {
+      if (assignment->children.p[ASSIGN_TARGET].kind != N_CREMENT) {
         // First check the index if there is one
-        if (assignment->children.p[1].kind == N_INDEX) {
-          index = assignment->children.p + 1;
+        if (assignment->children.p[ASSIGN_INDEX].kind == N_INDEX) {
+          index = assignment->children.p + ASSIGN_INDEX;
 
-          variableEliminationExpression(o, index->children.p + 1, vars);
+          variableEliminationExpression(o, index->children.p, vars);
         }
 
         // Then check the expression
@@ -335,105 +354,68 @@ bool variableEliminationStatement(Optimiser *o, Node *state, Node *block, int i,
       }
     }
 
-    changed |= variableEliminationBlock(
-        o, state->children.p + state->children.len - 1, vars);
+    changed |= variableEliminationBlock(o, state->children.p + FOR_BLOCK, vars);
 
     break;
 
   case N_IF_BLOCK:
     // Check condition and block, and repeat for each other case
-    variableEliminationExpression(o, state->children.p + 2, vars);
+    for (j = 0; j + IF_THEN < state->children.len; j += IF_STEP) {
+      variableEliminationExpression(o, state->children.p + j + IF_COND, vars);
 
-    changed |= variableEliminationBlock(o, state->children.p + 4, vars);
-
-    j = 5;
-
-    while (j < state->children.len) {
-      if (state->children.p[j].kind == N_ELIF) {
-
-        variableEliminationExpression(o, state->children.p + j + 2, vars);
-
-        changed |= variableEliminationBlock(o, state->children.p + j + 4, vars);
+      changed |=
+          variableEliminationBlock(o, state->children.p + j + IF_THEN, vars);
+    }
 
-        j += 5;
-      } else { // Else
-        changed |= variableEliminationBlock(o, state->children.p + j + 1, vars);
-        break;
-      }
+    // Else
+    if (j < state->children.len) {
+      changed |= variableEliminationBlock(o, state->children.p + j, vars);
     }
     break;
 
   case N_RET_STATE:
-    if (state->children.p[1].kind == N_EXPRESSION) {
-      variableEliminationExpression(o, state->children.p + 1, vars);
+    if (state->children.len == 1) {
+      variableEliminationExpression(o, state->children.p, vars);
     }
     break;
 
   case N_SWITCH_STATE:
     // Check item, and all cases + default.
-    variableEliminationExpression(o, state->children.p + 2, vars);
-
-    j = 5;
+    variableEliminationExpression(o, state->children.p + SWITCH_EXPR, vars);
 
     // NOTE: Calling 'variableEliminationBlock' with caseBlock and default block
     // is fine
 
-    Node *caseBlock = state->children.p + j;
-    while (caseBlock->kind == N_CASE_BLOCK) {
+    for (int k = SWITCH_CASES; k < state->children.len; ++k) {
+      Node *caseBlock = state->children.p + k;
+      int first = 0;
 
-      variableEliminationExpression(o, caseBlock->children.p + 1, vars);
-
-      int varLen = vars->len;
-
-      // For every statement
-      for (j = 3; j < caseBlock->children.len; ++j) {
-        Node *state = caseBlock->children.p + j;
-        changed |= variableEliminationStatement(o, state, caseBlock, j, vars);
-      }
-
-      // Cleanup vars
-      while (vars->len > varLen) {
-        j = varLen - 1;
-        v = vars->p[j];
-
-        // Remove from code
-        if (!v.used) {
-          changed = true;
-          removeVariable(o, v);
-        }
-
-        // Remove from vars
-        if (VarListRemoveAt(vars, vars->len - 1)) {
-          panic("Couldn't remove from list\n");
-        }
+      if (caseBlock->kind == N_CASE_BLOCK) {
+        variableEliminationExpression(o, caseBlock->children.p + CASE_EXPR,
+                                      vars);
+        first = CASE_STATEMENTS;
       }
 
-      ++j;
-      caseBlock = state->children.p + j;
-    }
-
-    if (caseBlock->kind == N_DEFAULT_BLOCK) {
       int varLen = vars->len;
 
       // For every statement
-      for (j = 2; j < caseBlock->children.len; ++j) {
+      for (j = first; j < caseBlock->children.len; ++j) {
         Node *state = caseBlock->children.p + j;
         changed |= variableEliminationStatement(o, state, caseBlock, j, vars);
       }
 
       // Cleanup vars
       while (vars->len > varLen) {
-        j = varLen - 1;
-        v = vars->p[j];
+        v = vars->p[vars->len - 1];
 
         // Remove from code
         if (!v.used) {
-          removeVariable(o, v);
           changed = true;
+          removeVariable(o, v);
         }
 
         // Remove from vars
-        if (VarListRemoveAt(vars, vars->len - 1)) {
+        if (VarListPop(vars, NULL)) {
           panic("Couldn't remove from list\n");
         }
       }
@@ -455,7 +437,7 @@ bool variableEliminationBlock(Optimiser *o, Node *block, VarList *vars) {
   int varLen = vars->len;
 
   // For every statement
-  for (int i = 1; i < block->children.len - 1; ++i) {
+  for (int i = 0; i < block->children.len; ++i) {
     Node *state = block->children.p + i;
     changed |= variableEliminationStatement(o, state, block, i, vars);
   }
@@ -473,7 +455,7 @@ bool variableEliminationBlock(Optimiser *o, Node *block, VarList *vars) {
     }
 
     // Remove from vars
-    if (VarListRemoveAt(vars, vars->len - 1)) {
+    if (VarListPop(vars, NULL)) {
       panic("Couldn't remove from list\n");
     }
   }
@@ -495,10 +477,13 @@ bool variableElimination(Optimiser *o) {
     Node *fn = o->src.children.p + i;
 
     // Optimise the block
-    changed |= variableEliminationBlock(
-        o, fn->children.p + fn->children.len - 1, &vars);
+    TRACE_BEGIN("optimise", fn->children.p[DEF_NAME].data);
+    changed |= variableEliminationBlock(o, fn->children.p + FUNC_DEF_BLOCK,
+                                        &vars);
+    TRACE_END("optimise", fn->children.p[DEF_NAME].data);
   }
 
+  VarListDestroy(&vars);
   return changed;
 }
 
@@ -556,13 +541,15 @@ Const getConstFromExpr(Optimiser *o, Node *expr) {
     return (Const){N_ILLEGAL};
   }
 
-  Node *val = expr->children.p;
+  Node *val = expr->children.p + EXPR_LEFT;
   return getConstFromValue(o, val);
 }
 
 bool branchEliminationBlock(Optimiser *o, Node *block);
 
-bool branchEliminationStatement(Optimiser *o, Node *state, Node *block, int i) {
+// state is at i in the block edits is batching
+bool branchEliminationStatement(Optimiser *o, Node *state, NodeEdits *edits,
+                                int i) {
   // printf("Eliminating branches (statement) %s\n",
   // nodeCodeString(state->kind));
   bool changed = false;
@@ -572,15 +559,14 @@ bool branchEliminationStatement(Optimiser *o, Node *state, Node *block, int i) {
   switch (state->kind) {
   case N_FOR_LOOP:
     // Empty block
-    if (state->children.p[state->children.len - 1].children.len == 2) {
+    if (state->children.p[FOR_BLOCK].children.len == 0) {
       changed = true;
 
       // Remove the loop
-      NODE_LIST_REMOVE(&block->children, i)
+      nodeEditsRemove(edits, i, 1);
     } else {
       // Check child block
-      changed |= branchEliminationBlock(o, state->children.p +
-                                               state->children.len - 1);
+      changed |= branchEliminationBlock(o, state->children.p + FOR_BLOCK);
     }
     break;
   case N_IF_BLOCK:
@@ -591,49 +577,47 @@ bool branchEliminationStatement(Optimiser *o, Node *state, Node *block, int i) {
     // printf("If statement\n%s\n", out);
     // free(out);
 
+    // An else is a block on its own at the end, an elif is a condition and
+    // block after the if's
     recBlock = state->children.p + state->children.len - 1;
-    if (state->children.p[state->children.len - 2].kind == N_ELSE) {
+    if (state->children.len % 2 == 1) {
       // Check child block
       changed |= branchEliminationBlock(o, recBlock);
 
       // Empty block
-      if (recBlock->children.len == 2) {
+      if (recBlock->children.len == 0) {
         changed = true;
-        printf("Removing else statement\n");
+        LOG("Removing else statement\n");
 
         // Remove the loop
-        for (int j = 0; j < 2; j++) {
-          NODE_LIST_REMOVE(&state->children, state->children.len - 1)
-        }
+        NODE_LIST_REMOVE_N(&state->children, state->children.len - 1, 1)
       }
-    } else if (state->children.p[state->children.len - 5].kind == N_ELIF) {
+    } else if (state->children.len > 2) {
       // Check child block
       changed |= branchEliminationBlock(o, recBlock);
 
       // Empty block
-      if (recBlock->children.len == 2) {
+      if (recBlock->children.len == 0) {
         changed = true;
-        printf("Removing elif statement\n");
+        LOG("Removing elif statement\n");
 
         // Remove the loop
-        for (int j = 0; j < 5; j++) {
-          NODE_LIST_REMOVE(&state->children, state->children.len - 1)
-        }
+        NODE_LIST_REMOVE_N(&state->children, state->children.len - 2, 2)
       }
     } else { // Single if statement
       // Check child block
       changed |= branchEliminationBlock(o, recBlock);
 
       // Empty block
-      if (recBlock->children.len == 2) {
+      if (recBlock->children.len == 0) {
         changed = true;
-        printf("Removing empty if statement\n");
+        LOG("Removing empty if statement\n");
 
         // Remove the loop
-        NODE_LIST_REMOVE(&block->children, i)
+        nodeEditsRemove(edits, i, 1);
       } else {
         // Try to eliminate based on constant value
-        Const c = getConstFromExpr(o, state->children.p + 2);
+        Const c = getConstFromExpr(o, state->children.p + IF_COND);
 
         bool isTrue = false;
 
@@ -659,24 +643,19 @@ bool branchEliminationStatement(Optimiser *o, Node *state, Node *block, int i) {
 
         if (isTrue) { // The branch always happens
           changed = true;
-          printf("Removing true if statement\n");
-
-          // Remove the loop
-          NODE_LIST_REMOVE(&block->children, i)
+          LOG("Removing true if statement\n");
 
-          for (int j = 1; j < recBlock->children.len - 1; ++j) {
-            if (NodeListInsertAt(&block->children, recBlock->children.p[j],
-                                 i)) {
-              panic("Couldn't insert in nodelist\n");
-            }
-          }
+          // Everything in the block takes its place, in order. recBlock's
+          // own edits were applied when it was checked above
+          nodeEditsSplice(edits, i, 1, recBlock->children.p,
+                          recBlock->children.len);
 
         } else { // The branch never happens
           changed = true;
-          printf("Removing false if statement\n");
+          LOG("Removing false if statement\n");
 
           // Remove the loop
-          NODE_LIST_REMOVE(&block->children, i)
+          nodeEditsRemove(edits, i, 1);
         }
       }
     }
@@ -696,12 +675,19 @@ bool branchEliminationBlock(Optimiser *o, Node *block) {
 
   bool changed = false;
 
+  // Statements are removed and spliced in once every one has been checked,
+  // so until then i is always where the statement started
+  NodeEdits edits;
+  nodeEditsInit(&edits, &block->children);
+
   // For every statement
-  for (int i = 1; i < block->children.len - 1; ++i) {
+  for (int i = 0; i < block->children.len; ++i) {
     Node *state = block->children.p + i;
-    changed |= branchEliminationStatement(o, state, block, i);
+    changed |= branchEliminationStatement(o, state, &edits, i);
   }
 
+  nodeEditsApply(&edits);
+  nodeEditsDestroy(&edits);
   return changed;
 }
 
@@ -714,7 +700,9 @@ bool branchElimination(Optimiser *o) {
     Node *fn = o->src.children.p + i;
 
     // Optimise the block
-    changed |= branchEliminationBlock(o, fn->children.p + fn->children.len - 1);
+    TRACE_BEGIN("optimise", fn->children.p[DEF_NAME].data);
+    changed |= branchEliminationBlock(o, fn->children.p + FUNC_DEF_BLOCK);
+    TRACE_END("optimise", fn->children.p[DEF_NAME].data);
   }
 
   return changed;
@@ -727,27 +715,23 @@ bool valueFold(Optimiser *o, Node *n) {
 
   switch (n->kind) {
   case N_MAKE_ARRAY:
-    for (int i = 2; i < n->children.len - 1; i += 2) {
+    for (int i = 0; i < n->children.len; ++i) {
       changed |= expressionFold(o, n->children.p + i);
     }
     return changed;
   case N_FUNC_CALL:
-    for (int i = 3; i < n->children.len - 1; i += 2) {
-      changed |= expressionFold(o, n->children.p + i);
-    }
-    return changed;
   case N_STRUCT_NEW:
-    for (int i = 2; i < n->children.len - 1; i += 2) {
+    for (int i = CALL_ARGS; i < n->children.len; ++i) {
       changed |= expressionFold(o, n->children.p + i);
     }
     return changed;
   case N_BRACKETED_VALUE:
-    changed |= expressionFold(o, n->children.p + 1);
+    changed |= expressionFold(o, n->children.p);
 
     // If it's a single value in the brackets, take it out
-    Node *innerExpr = n->children.p + 1;
+    Node *innerExpr = n->children.p;
     if (innerExpr->children.len == 1) {
-      *n = innerExpr->children.p[0];
+      *n = innerExpr->children.p[EXPR_LEFT];
     }
     return changed;
 
@@ -762,38 +746,39 @@ bool expressionFold(Optimiser *o, Node *n) {
 
   // Only need to check one value
   if (n->children.len == 1) {
-    return valueFold(o, n->children.p);
+    return valueFold(o, n->children.p + EXPR_LEFT);
   }
 
   // Are we able to turn the 2 values into a single one?
   bool changed = false;
 
   // Fold both values in expression
-  changed |= valueFold(o, n->children.p);
-  changed |= valueFold(o, n->children.p + 2);
+  changed |= valueFold(o, n->children.p + EXPR_LEFT);
+  changed |= valueFold(o, n->children.p + EXPR_RIGHT);
 
   // Get the constant value (if it is constant)
   Const left, right;
-  left = getConstFromValue(o, n->children.p);
-  right = getConstFromValue(o, n->children.p + 2);
+  left = getConstFromValue(o, n->children.p + EXPR_LEFT);
+  right = getConstFromValue(o, n->children.p + EXPR_RIGHT);
 
-  NodeCode op = n->children.p[1].kind;
+  NodeCode op = n->children.p[EXPR_OP].kind;
 
   // Can we fold?
   if (left.type == N_ILLEGAL || right.type == N_ILLEGAL) {
     // Before we take this as a loss, we should check whether this expression is
     // comparing the same identifier
-    if (n->children.p[0].kind != N_IDENTIFIER ||
-        n->children.p[2].kind != N_IDENTIFIER) {
+    if (n->children.p[EXPR_LEFT].kind != N_IDENTIFIER ||
+        n->children.p[EXPR_RIGHT].kind != N_IDENTIFIER) {
       return changed;
     }
 
     // Same name?
-    if (strcmp(n->children.p[0].data, n->children.p[2].data)) {
+    if (!SAME_SYMBOL(n->children.p[EXPR_LEFT].data,
+                     n->children.p[EXPR_RIGHT].data)) {
       return changed;
     }
 
-    Node final = n->children.p[0];
+    Node final = n->children.p[EXPR_LEFT];
 
     // Attempt a replacement
     switch (op) {
@@ -840,11 +825,10 @@ bool expressionFold(Optimiser *o, Node *n) {
     }
 
     // Replace left with new node
-    n->children.p[0] = final;
+    n->children.p[EXPR_LEFT] = final;
 
     // Delete the op and right
-    NODE_LIST_REMOVE(&n->children, 1)
-    NODE_LIST_REMOVE(&n->children, 1)
+    NODE_LIST_REMOVE_N(&n->children, EXPR_OP, 2)
 
     return changed;
   }
@@ -924,6 +908,7 @@ bool expressionFold(Optimiser *o, Node *n) {
     // Now we have the value in iv, we have to rearrange the expression to add
     // it in
     v = malloc(20);
+    STAT_ALLOC(SUB_OPTIMISER, 20)
     if (_itoa_s(iv, v, 20, 10)) {
       panic("Couldn't str number\n");
     }
@@ -932,14 +917,14 @@ bool expressionFold(Optimiser *o, Node *n) {
     final = getString(o->sm, v);
 
     // Free v since it's on the string registry now
+    STAT_FREE(SUB_OPTIMISER, 20)
     free(v);
 
     // Replace left with new node
-    n->children.p[0].data = final;
+    n->children.p[EXPR_LEFT].data = final;
 
     // Delete the op and right
-    NODE_LIST_REMOVE(&n->children, 1)
-    NODE_LIST_REMOVE(&n->children, 1)
+    NODE_LIST_REMOVE_N(&n->children, EXPR_OP, 2)
     break;
   case N_TRUE:
     // TODO: Implement folding booleans
@@ -1004,14 +989,14 @@ Stopper constantPropogateRec(Optimiser *o, Node *n, char *name, Const c) {
       break;
     }
 
-    if (assignment->children.p[0].kind == N_CREMENT) {
-      assignment = assignment->children.p;
+    if (assignment->children.p[ASSIGN_TARGET].kind == N_CREMENT) {
+      assignment = assignment->children.p + ASSIGN_TARGET;
 
-      if (strcmp(name, assignment->children.p[1].data)) {
+      if (!SAME_SYMBOL(name, assignment->children.p[CREMENT_TARGET].data)) {
         break;
       }
 
-      if (assignment->children.p[0].kind == N_INC) {
+      if (assignment->children.p[CREMENT_OP].kind == N_INC) {
         switch (c.type) {
         case N_CHAR:
           c.val.c++;
@@ -1043,7 +1028,7 @@ Stopper constantPropogateRec(Optimiser *o, Node *n, char *name, Const c) {
       return (Stopper){false, true, false, c};
     }
 
-    if (strcmp(name, assignment->children.p[0].data)) {
+    if (!SAME_SYMBOL(name, assignment->children.p[ASSIGN_TARGET].data)) {
       break;
     }
     c = getConstFromExpr(o,
@@ -1054,7 +1039,7 @@ Stopper constantPropogateRec(Optimiser *o, Node *n, char *name, Const c) {
     return (Stopper){false, true, false, c};
 
   case N_IDENTIFIER:
-    if (cmpStr(name, n->data)) {
+    if (SAME_SYMBOL(name, n->data)) {
       n->data = c.data;
       n->kind = c.type;
       return (Stopper){true, false, false};
@@ -1106,7 +1091,7 @@ bool constantPropogation(Optimiser *o, Node *n, Node *parent, int i) {
   }
 
   // Get the expression that is used for this assignment
-  Node *expr = assignment->children.p + assignment->children.len - 1;
+  Node *expr = assignment->children.p + NEW_ASSIGNMENT_EXPR;
   Const c = getConstFromExpr(o, expr);
 
   // Is it constant?
@@ -1118,7 +1103,7 @@ bool constantPropogation(Optimiser *o, Node *n, Node *parent, int i) {
   bool changed = false;
 
   // Keep a reference to the name of the variable
-  char *name = assignment->children.p[2].data;
+  char *name = assignment->children.p[NEW_ASSIGNMENT_NAME].data;
 
   Stopper s;
 
@@ -1165,22 +1150,21 @@ bool constantFolding(Optimiser *o) {
 
 bool strengthReduction(Optimiser *o) { return false; }
 
-void optimise(Optimiser *o) {
-RETRY_OPTIMISATION:
-
-  if (variableElimination(o)) {
-    goto RETRY_OPTIMISATION;
-  }
-
-  if (branchElimination(o)) {
-    goto RETRY_OPTIMISATION;
+// Each pass gets its own span every time it runs
+#define RUN_PASS(pass)                                                         \
+  TRACE_BEGIN("pass", #pass);                                                  \
+  changed = pass(o);                                                           \
+  TRACE_END("pass", #pass);                                                    \
+  if (changed) {                                                               \
+    goto RETRY_OPTIMISATION;                                                   \
   }
 
-  if (constantFolding(o)) {
-    goto RETRY_OPTIMISATION;
-  }
+void optimise(Optimiser *o) {
+  bool changed;
 
-  if (strengthReduction(o)) {
-    goto RETRY_OPTIMISATION;
-  }
+RETRY_OPTIMISATION:
+  RUN_PASS(variableElimination)
+  RUN_PASS(branchElimination)
+  RUN_PASS(constantFolding)
+  RUN_PASS(strengthReduction)
 }
@@ -1,7 +1,19 @@
+#include "Panic.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 
+thread_local jmp_buf *errorRecovery = NULL;
+
+void fail(void) {
+  if (errorRecovery != NULL) {
+    longjmp(*errorRecovery, 1);
+  }
+
+  exit(1);
+}
+
 void panic(char *msg) {
   printf("%s\n", msg);
-  exit(1);
+  fail();
 }
@@ -1,3 +1,13 @@
 #pragma once
 
+#include <setjmp.h>
+#include <threads.h>
+
+// When set, errors on this thread jump here instead of exiting, so a
+// long-running process can carry on after a bad file
+extern thread_local jmp_buf *errorRecovery;
+
+// Stops compiling after an error has been printed
+void fail(void);
+
 void panic(char *msg);
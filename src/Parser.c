@@ -6,6 +6,8 @@
 
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define CHECK_TOK(tokenCode, expected)                                         \
   if (p->tok.kind != (tokenCode)) {                                            \
@@ -18,6 +20,11 @@
     panic("Couldn't append to Node list in " funcName);                        \
   }
 
+// Punctuation and keywords are checked and skipped, they aren't kept
+#define CHECK_NEXT(tokenCode, expected)                                        \
+  CHECK_TOK((tokenCode), (expected))                                           \
+  nextToken(p);
+
 #define CHECK_AND_APPEND(tokenCode, expected, nodeCode, nodeData, funcName)    \
   CHECK_TOK((tokenCode), (expected))                                           \
   APPEND_NODE((nodeCode), (nodeData), funcName)
@@ -27,15 +34,18 @@
   APPEND_NODE((nodeCode), (nodeData), funcName)                                \
   nextToken(p);
 
+#define APPEND_EMPTY(funcName)                                                 \
+  APPEND_NODE(N_EMPTY, NULL, funcName)
+
 #define APPEND_STRUCTURE(func, funcName)                                       \
   if (NodeListAppend(&out.children, func(p))) {                                \
     panic("Couldn't append to Node list in " funcName);                        \
   }
 
-void parserInit(Parser *p, char *sourceName, TokenList source,
-                StringManager *sm) {
+void parserInit(Parser *p, char *sourceName, Lexer *source, StringManager *sm) {
   p->sourceName = sourceName;
   p->source = source;
+  p->lexed = 0;
   p->index = 0;
   p->tok.kind = T_ILLEGAL;
   p->sm = sm;
@@ -90,60 +100,102 @@ bool validUnary(Parser *p) {
   }
 }
 
-void nextToken(Parser *p) {
-  Token t = {NULL, T_ILLEGAL, 0};
+// Gets the token at this position in the source, lexing up to it if needed
+Token tokenAt(Parser *p, int index) {
+  if (index < 0) {
+    return ZERO_TOKEN;
+  }
 
-  if (p->index < p->source.len) {
-    t = p->source.p[p->index];
+  // Past the end of the source the lexer keeps giving illegal tokens
+  while (p->lexed <= index) {
+    p->window[p->lexed & (TOKEN_WINDOW - 1)] = lexToken(p->source);
+    ++p->lexed;
   }
 
+  if (index <= p->lexed - TOKEN_WINDOW) {
+    panic("Parser went back further than the token window");
+  }
+
+  return p->window[index & (TOKEN_WINDOW - 1)];
+}
+
+void nextToken(Parser *p) {
+  p->tok = tokenAt(p, p->index);
   ++p->index;
-  p->tok = t;
 }
 
 void prevToken(Parser *p) {
-  Token t = {NULL, T_ILLEGAL, 0};
-
-  if (p->index > 0) {
-    t = p->source.p[p->index - 1];
-  }
-
+  p->tok = tokenAt(p, p->index - 1);
   --p->index;
-  p->tok = t;
 }
 
-Token peekToken(Parser *p) {
-  if (p->index < p->source.len) {
-    return p->source.p[p->index];
+Token peekToken(Parser *p) { return tokenAt(p, p->index); }
+
+// Interns the text of the current token, which until now has only been a slice
+// of the source
+char *tokenText(Parser *p) {
+  char *text = p->source->source + p->tok.start;
+  int len = p->tok.len;
+
+  switch (p->tok.kind) {
+  case T_IDENTIFIER:
+    return getSymbolHashed(p->sm, text, len, p->tok.hash).str;
+
+  case T_INT:
+  case T_FLOAT:
+    if (memchr(text, '_', len) == NULL) {
+      break;
+    }
+
+    // Underscores only separate digits, so drop them
+    char *digits = malloc(len * sizeof(char));
+    if (digits == NULL) {
+      panic("Couldn't allocate number text");
+    }
+
+    int digitLen = 0;
+    for (int i = 0; i < len; ++i) {
+      if (text[i] != '_') {
+        digits[digitLen] = text[i];
+        ++digitLen;
+      }
+    }
+
+    char *out = getSymbol(p->sm, digits, digitLen).str;
+    free(digits);
+    return out;
+
+  default:
+    break;
   }
 
-  return (Token){NULL, T_ILLEGAL, 0};
+  return getSymbol(p->sm, text, len).str;
 }
 
 void throwParserError(Parser *p, char expected[]) {
   printf("Error in the Parser!\n"
          "Error found in file: %s\nOn line: %i\nExpected: %s\nGot: %s\n",
-         p->sourceName, p->tok.line, expected, tokenString(p->tok));
-  exit(1);
+         p->sourceName, p->tok.line, expected,
+         tokenString(p->tok, p->source->source));
+  fail();
 }
 
 Node parseStruct(Parser *p) {
   Node out = newNode(N_STRUCT_DEF, getString(p->sm, "Struct Def"), p->tok.line,
                      p->sourceName);
 
-  CHECK_APPEND_NEXT(T_STRUCT, "struct", N_STRUCT, NULL, "parseStruct")
-  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+  CHECK_NEXT(T_STRUCT, "struct")
+  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                     "parseStruct")
-  CHECK_APPEND_NEXT(T_L_SQUIRLY, "{", N_L_SQUIRLY, NULL, "parseStruct")
+  CHECK_NEXT(T_L_SQUIRLY, "{")
 
   APPEND_STRUCTURE(parseComplexType, "parseStruct");
   nextToken(p);
 
-  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                     "parseStruct")
 
   while (p->tok.kind == T_SEP) {
-    APPEND_NODE(N_SEP, NULL, "parseStruct")
     nextToken(p);
 
     if (p->tok.kind == T_R_SQUIRLY) {
@@ -153,16 +205,15 @@ Node parseStruct(Parser *p) {
     APPEND_STRUCTURE(parseComplexType, "parseStruct");
     nextToken(p);
 
-    CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+    CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                       "parseStruct")
   }
 
   if (p->tok.kind == T_SEP) {
-    APPEND_NODE(N_SEP, NULL, "parseStruct")
     nextToken(p);
   }
 
-  CHECK_AND_APPEND(T_R_SQUIRLY, "}", N_R_SQUIRLY, NULL, "parseStruct")
+  CHECK_TOK(T_R_SQUIRLY, "}")
 
   return out;
 }
@@ -171,31 +222,29 @@ Node parseEnum(Parser *p) {
   Node out = newNode(N_ENUM_DEF, getString(p->sm, "Enum Def"), p->tok.line,
                      p->sourceName);
 
-  CHECK_APPEND_NEXT(T_ENUM, "enum", N_ENUM, NULL, "parseEnum")
-  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+  CHECK_NEXT(T_ENUM, "enum")
+  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                     "parseEnum")
-  CHECK_APPEND_NEXT(T_L_SQUIRLY, "{", N_L_SQUIRLY, NULL, "parseEnum")
-  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+  CHECK_NEXT(T_L_SQUIRLY, "{")
+  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                     "parseEnum")
 
   while (p->tok.kind == T_SEP) {
-    APPEND_NODE(N_SEP, NULL, "parseEnum")
     nextToken(p);
 
     if (p->tok.kind == T_R_SQUIRLY) {
       break;
     }
 
-    CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+    CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                       "parseEnum")
   }
 
   if (p->tok.kind == T_SEP) {
-    APPEND_NODE(N_SEP, NULL, "parseEnum")
     nextToken(p);
   }
 
-  CHECK_APPEND_NEXT(T_R_SQUIRLY, "}", N_R_SQUIRLY, NULL, "parseEnum")
+  CHECK_TOK(T_R_SQUIRLY, "}")
 
   return out;
 }
@@ -204,40 +253,44 @@ Node parseFunc(Parser *p) {
   Node out = newNode(N_FUNC_DEF, getString(p->sm, "Func Def"), p->tok.line,
                      p->sourceName);
 
-  CHECK_APPEND_NEXT(T_FUN, "fun", N_FUN, NULL, "parseFunc")
-  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+  CHECK_NEXT(T_FUN, "fun")
+  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                     "parseFunc")
-  CHECK_APPEND_NEXT(T_L_PAREN, "(", N_L_PAREN, NULL, "parseFunc")
+  CHECK_NEXT(T_L_PAREN, "(")
+
+  // The return type and block come after the params, their places are kept
+  // until they're parsed
+  APPEND_EMPTY("parseFunc")
+  APPEND_EMPTY("parseFunc")
 
   // We have params
   if (p->tok.kind != T_R_PAREN) {
     APPEND_STRUCTURE(parseComplexType, "parseFunc");
     nextToken(p);
 
-    CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+    CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                       "parseFunc")
 
     while (p->tok.kind == T_SEP) {
-      APPEND_NODE(N_SEP, NULL, "parseFunc")
       nextToken(p);
 
       APPEND_STRUCTURE(parseComplexType, "parseFunc");
       nextToken(p);
 
-      CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+      CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                         "parseFunc")
     }
   }
 
-  CHECK_APPEND_NEXT(T_R_PAREN, ")", N_R_PAREN, NULL, "parseFunc")
+  CHECK_NEXT(T_R_PAREN, ")")
 
   // Return type
   if (p->tok.kind != T_L_SQUIRLY) {
-    APPEND_STRUCTURE(parseComplexType, "parseFunc");
+    out.children.p[FUNC_DEF_RET] = parseComplexType(p);
     nextToken(p);
   }
 
-  APPEND_STRUCTURE(parseBlock, "parseFunc");
+  out.children.p[FUNC_DEF_BLOCK] = parseBlock(p);
 
   return out;
 }
@@ -291,12 +344,12 @@ Node parseIndex(Parser *p) {
   Node out =
       newNode(N_INDEX, getString(p->sm, "Index"), p->tok.line, p->sourceName);
 
-  CHECK_APPEND_NEXT(T_L_BLOCK, "[", N_L_BLOCK, NULL, "parseIndex")
+  CHECK_NEXT(T_L_BLOCK, "[")
 
   APPEND_STRUCTURE(parseExpression, "parseIndex");
   nextToken(p);
 
-  CHECK_AND_APPEND(T_R_BLOCK, "]", N_R_BLOCK, NULL, "parseIndex")
+  CHECK_TOK(T_R_BLOCK, "]")
 
   return out;
 }
@@ -305,33 +358,30 @@ Node parseIfBlock(Parser *p) {
   Node out = newNode(N_IF_BLOCK, getString(p->sm, "If Block"), p->tok.line,
                      p->sourceName);
 
-  CHECK_APPEND_NEXT(T_IF, "if", N_IF, NULL, "parseIfBlock")
-  CHECK_APPEND_NEXT(T_L_PAREN, "(", N_L_PAREN, NULL, "parseIfBlock")
+  CHECK_NEXT(T_IF, "if")
+  CHECK_NEXT(T_L_PAREN, "(")
 
   APPEND_STRUCTURE(parseExpression, "parseIfBlock");
   nextToken(p);
 
-  CHECK_APPEND_NEXT(T_R_PAREN, ")", N_R_PAREN, NULL, "parseIfBlock")
+  CHECK_NEXT(T_R_PAREN, ")")
   APPEND_STRUCTURE(parseBlock, "parseIfBlock");
 
   if (peekToken(p).kind == T_ELIF) {
     nextToken(p);
-    APPEND_NODE(N_ELIF, NULL, "parseIfBlock")
-    nextToken(p);
-
-    CHECK_APPEND_NEXT(T_L_PAREN, "(", N_L_PAREN, NULL, "parseIfBlock")
+    CHECK_NEXT(T_ELIF, "elif")
+    CHECK_NEXT(T_L_PAREN, "(")
 
     APPEND_STRUCTURE(parseExpression, "parseIfBlock")
     nextToken(p);
 
-    CHECK_APPEND_NEXT(T_R_PAREN, ")", N_R_PAREN, NULL, "parseIfBlock")
+    CHECK_NEXT(T_R_PAREN, ")")
     APPEND_STRUCTURE(parseBlock, "parseIfBlock")
   }
 
   if (peekToken(p).kind == T_ELSE) {
     nextToken(p);
-    APPEND_NODE(N_ELSE, NULL, "parseIfBlock")
-    nextToken(p);
+    CHECK_NEXT(T_ELSE, "else")
 
     APPEND_STRUCTURE(parseBlock, "parseIfBlock")
   }
@@ -343,8 +393,8 @@ Node parseForLoop(Parser *p) {
   Node out = newNode(N_FOR_LOOP, getString(p->sm, "For Loop"), p->tok.line,
                      p->sourceName);
 
-  CHECK_APPEND_NEXT(T_FOR, "for", N_FOR, NULL, "parseForLoop")
-  CHECK_APPEND_NEXT(T_L_PAREN, "(", N_L_PAREN, NULL, "parseForLoop")
+  CHECK_NEXT(T_FOR, "for")
+  CHECK_NEXT(T_L_PAREN, "(")
 
   if (p->tok.kind == T_LET) {
     APPEND_STRUCTURE(parseNewAssignment, "parseForLoop")
@@ -352,23 +402,29 @@ Node parseForLoop(Parser *p) {
   } else if (p->tok.kind != T_SEMICOLON) {
     APPEND_STRUCTURE(parseAssignment, "parseForLoop")
     nextToken(p);
+  } else {
+    APPEND_EMPTY("parseForLoop")
   }
 
-  CHECK_APPEND_NEXT(T_SEMICOLON, ";", N_SEMICOLON, NULL, "parseForLoop")
+  CHECK_NEXT(T_SEMICOLON, ";")
 
   if (p->tok.kind != T_SEMICOLON) {
     APPEND_STRUCTURE(parseExpression, "parseForLoop")
     nextToken(p);
+  } else {
+    APPEND_EMPTY("parseForLoop")
   }
 
-  CHECK_APPEND_NEXT(T_SEMICOLON, ";", N_SEMICOLON, NULL, "parseForLoop")
+  CHECK_NEXT(T_SEMICOLON, ";")
 
   if (p->tok.kind != T_R_PAREN) {
     APPEND_STRUCTURE(parseAssignment, "parseForLoop")
     nextToken(p);
+  } else {
+    APPEND_EMPTY("parseForLoop")
   }
 
-  CHECK_APPEND_NEXT(T_R_PAREN, ")", N_R_PAREN, NULL, "parseForLoop")
+  CHECK_NEXT(T_R_PAREN, ")")
   APPEND_STRUCTURE(parseBlock, "parseForLoop")
 
   return out;
@@ -378,14 +434,14 @@ Node parseRetState(Parser *p) {
   Node out = newNode(N_RET_STATE, getString(p->sm, "Ret State"), p->tok.line,
                      p->sourceName);
 
-  CHECK_APPEND_NEXT(T_RETURN, "return", N_RETURN, NULL, "parseRetState")
+  CHECK_NEXT(T_RETURN, "return")
 
   if (p->tok.kind != T_SEMICOLON) {
     APPEND_STRUCTURE(parseExpression, "parseRetState")
     nextToken(p);
   }
 
-  CHECK_AND_APPEND(T_SEMICOLON, ";", N_SEMICOLON, NULL, "parseRetState")
+  CHECK_TOK(T_SEMICOLON, ";")
 
   return out;
 }
@@ -394,8 +450,8 @@ Node parseBreakState(Parser *p) {
   Node out = newNode(N_BREAK_STATE, getString(p->sm, "Break State"),
                      p->tok.line, p->sourceName);
 
-  CHECK_APPEND_NEXT(T_BREAK, "break", N_BREAK, NULL, "parseBreakState")
-  CHECK_AND_APPEND(T_SEMICOLON, ";", N_SEMICOLON, NULL, "parseBreakState")
+  CHECK_NEXT(T_BREAK, "break")
+  CHECK_TOK(T_SEMICOLON, ";")
 
   return out;
 }
@@ -404,9 +460,8 @@ Node parseContinueState(Parser *p) {
   Node out = newNode(N_CONTINUE_STATE, getString(p->sm, "Continue State"),
                      p->tok.line, p->sourceName);
 
-  CHECK_APPEND_NEXT(T_CONTINUE, "continue", N_CONTINUE, NULL,
-                    "parseContinueState")
-  CHECK_AND_APPEND(T_SEMICOLON, ";", N_SEMICOLON, NULL, "parseContinueState")
+  CHECK_NEXT(T_CONTINUE, "continue")
+  CHECK_TOK(T_SEMICOLON, ";")
 
   return out;
 }
@@ -415,12 +470,12 @@ Node parseBracketedValue(Parser *p) {
   Node out = newNode(N_BRACKETED_VALUE, getString(p->sm, "Bracketed Value"),
                      p->tok.line, p->sourceName);
 
-  CHECK_APPEND_NEXT(T_L_PAREN, "(", N_L_PAREN, NULL, "parseBracketedValue")
+  CHECK_NEXT(T_L_PAREN, "(")
 
   APPEND_STRUCTURE(parseExpression, "parseBracketedValue")
   nextToken(p);
 
-  CHECK_AND_APPEND(T_R_PAREN, ")", N_R_PAREN, NULL, "parseBracketedValue")
+  CHECK_TOK(T_R_PAREN, ")")
 
   return out;
 }
@@ -429,17 +484,16 @@ Node parseStructNew(Parser *p) {
   Node out = newNode(N_STRUCT_NEW, getString(p->sm, "Struct New"), p->tok.line,
                      p->sourceName);
 
-  CHECK_APPEND_NEXT(T_NEW, "new", N_STRUCT, NULL, "parseStructNew")
-  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+  CHECK_NEXT(T_NEW, "new")
+  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                     "parseStructNew")
 
-  CHECK_APPEND_NEXT(T_L_PAREN, "(", N_L_PAREN, NULL, "parseStructNew")
+  CHECK_NEXT(T_L_PAREN, "(")
 
   APPEND_STRUCTURE(parseExpression, "parseStructNew")
   nextToken(p);
 
   while (p->tok.kind == T_SEP) {
-    APPEND_NODE(N_SEP, NULL, "parseStructNew")
     nextToken(p);
 
     APPEND_STRUCTURE(parseExpression, "parseStructNew")
@@ -447,11 +501,10 @@ Node parseStructNew(Parser *p) {
   }
 
   if (p->tok.kind == T_SEP) {
-    APPEND_NODE(N_SEP, NULL, "parseStructNew")
     nextToken(p);
   }
 
-  CHECK_AND_APPEND(T_R_PAREN, ")", N_R_PAREN, NULL, "parseStructNew")
+  CHECK_TOK(T_R_PAREN, ")")
 
   return out;
 }
@@ -460,16 +513,15 @@ Node parseFuncCall(Parser *p) {
   Node out = newNode(N_FUNC_CALL, getString(p->sm, "Func Call"), p->tok.line,
                      p->sourceName);
 
-  CHECK_APPEND_NEXT(T_CALL, "call", N_FUN, NULL, "parseFuncCall")
-  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+  CHECK_NEXT(T_CALL, "call")
+  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                     "parseFuncCall")
-  CHECK_APPEND_NEXT(T_L_PAREN, "(", N_L_PAREN, NULL, "parseFuncCall")
+  CHECK_NEXT(T_L_PAREN, "(")
 
   APPEND_STRUCTURE(parseExpression, "parseFuncCall")
   nextToken(p);
 
   while (p->tok.kind == T_SEP) {
-    APPEND_NODE(N_SEP, NULL, "parseFuncCall")
     nextToken(p);
 
     APPEND_STRUCTURE(parseExpression, "parseFuncCall")
@@ -477,11 +529,10 @@ Node parseFuncCall(Parser *p) {
   }
 
   if (p->tok.kind == T_SEP) {
-    APPEND_NODE(N_SEP, NULL, "parseFuncCall")
     nextToken(p);
   }
 
-  CHECK_AND_APPEND(T_R_PAREN, ")", N_R_PAREN, NULL, "parseFuncCall")
+  CHECK_TOK(T_R_PAREN, ")")
 
   return out;
 }
@@ -490,14 +541,13 @@ Node parseMakeArray(Parser *p) {
   Node out = newNode(N_MAKE_ARRAY, getString(p->sm, "Make Array"), p->tok.line,
                      p->sourceName);
 
-  CHECK_APPEND_NEXT(T_MAKE, "make", N_MAKE, NULL, "parseMakeArray")
-  CHECK_APPEND_NEXT(T_L_BLOCK, "[", N_L_BLOCK, NULL, "parseMakeArray")
+  CHECK_NEXT(T_MAKE, "make")
+  CHECK_NEXT(T_L_BLOCK, "[")
 
   APPEND_STRUCTURE(parseExpression, "parseMakeArray")
   nextToken(p);
 
   while (p->tok.kind == T_SEP) {
-    APPEND_NODE(N_SEP, NULL, "parseMakeArray")
     nextToken(p);
 
     APPEND_STRUCTURE(parseExpression, "parseMakeArray")
@@ -505,11 +555,10 @@ Node parseMakeArray(Parser *p) {
   }
 
   if (p->tok.kind == T_SEP) {
-    APPEND_NODE(N_SEP, NULL, "parseMakeArray")
     nextToken(p);
   }
 
-  CHECK_AND_APPEND(T_R_BLOCK, "]", N_R_BLOCK, NULL, "parseMakeArray")
+  CHECK_TOK(T_R_BLOCK, "]")
 
   return out;
 }
@@ -521,7 +570,7 @@ Node parseLoneCall(Parser *p) {
   APPEND_STRUCTURE(parseFuncCall, "parseLoneCall");
   nextToken(p);
 
-  CHECK_AND_APPEND(T_SEMICOLON, ";", N_SEMICOLON, NULL, "parseLoneCall")
+  CHECK_TOK(T_SEMICOLON, ";")
 
   return out;
 }
@@ -540,10 +589,7 @@ typedef enum Precedence {
 } Precedence;
 
 #define CLEAN_UP                                                               \
-  if (NodeListRemoveAt(&n.children, i)) {                                      \
-    panic("Couldn't remove from list in precedenceExpression");                \
-  }                                                                            \
-  if (NodeListRemoveAt(&n.children, i)) {                                      \
+  if (NodeListRemoveN(&n.children, i, 2)) {                                    \
     panic("Couldn't remove from list in precedenceExpression");                \
   }
 
@@ -559,7 +605,6 @@ typedef enum Precedence {
 #define CREATE_INNER_EXPR                                                      \
   Node expr =                                                                  \
       newNode(N_BRACKETED_VALUE, NULL, n.children.p[i].line, n.sourceName);    \
-  PREC_APPEND(lParen)                                                          \
   Node child =                                                                 \
       newNode(N_EXPRESSION, NULL, n.children.p[i].line, n.sourceName);         \
   if (NodeListAppend(&child.children, n.children.p[i - 1])) {                  \
@@ -572,7 +617,6 @@ typedef enum Precedence {
     panic("Couldn't append to list in precedenceExpression");                  \
   }                                                                            \
   PREC_APPEND(child)                                                           \
-  PREC_APPEND(rParen)                                                          \
   CLEAN_UP                                                                     \
   n.children.p[i - 1] = expr;                                                  \
   UPDATE_LEN
@@ -593,9 +637,6 @@ Node precedenceExpression(Node n) {
     return n;
   }
 
-  Node lParen = (Node){N_L_PAREN, ZERO_LIST, NULL, n.line, n.sourceName};
-  Node rParen = (Node){N_R_PAREN, ZERO_LIST, NULL, n.line, n.sourceName};
-
   PREC_OP(kind == N_MUL || kind == N_DIV || kind == N_MOD)
   PREC_OP(kind == N_ADD || kind == N_SUB)
   PREC_OP(kind == N_L_SHIFT || kind == N_R_SHIFT)
@@ -672,7 +713,7 @@ Node parseCrement(Parser *p) {
   if (peekToken(p).kind == T_ACCESSOR || peekToken(p).kind == T_P_ACCESSOR) {
     APPEND_STRUCTURE(parseAccess, "parseCrement")
   } else {
-    CHECK_AND_APPEND(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+    CHECK_AND_APPEND(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                      "parseCrement")
   }
 
@@ -697,7 +738,7 @@ Node parseAssignment(Parser *p) {
     APPEND_STRUCTURE(parseAccess, "parseAssignment")
     nextToken(p);
   } else {
-    CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+    CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                       "parseAssignment")
   }
 
@@ -707,7 +748,7 @@ Node parseAssignment(Parser *p) {
     nextToken(p);
   }
 
-  CHECK_APPEND_NEXT(T_ASSIGN, "=", N_ASSIGN, NULL, "parseAssignment")
+  CHECK_NEXT(T_ASSIGN, "=")
   APPEND_STRUCTURE(parseExpression, "parseAssignment");
 
   return out;
@@ -717,14 +758,14 @@ Node parseNewAssignment(Parser *p) {
   Node out = newNode(N_NEW_ASSIGNMENT, getString(p->sm, "New Assignment"),
                      p->tok.line, p->sourceName);
 
-  CHECK_APPEND_NEXT(T_LET, "let", N_LET, NULL, "parseNewAssignment")
+  CHECK_NEXT(T_LET, "let")
 
   APPEND_STRUCTURE(parseComplexType, "parseNewAssignment");
   nextToken(p);
 
-  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                     "parseNewAssignment")
-  CHECK_APPEND_NEXT(T_ASSIGN, "=", N_ASSIGN, NULL, "parseNewAssignment")
+  CHECK_NEXT(T_ASSIGN, "=")
   APPEND_STRUCTURE(parseExpression, "parseNewAssignment");
 
   return out;
@@ -745,7 +786,7 @@ Node parseVarDeclaration(Parser *p) {
 
   nextToken(p);
 
-  CHECK_AND_APPEND(T_SEMICOLON, ";", N_SEMICOLON, NULL, "parseVarDeclaration")
+  CHECK_TOK(T_SEMICOLON, ";")
 
   return out;
 }
@@ -801,7 +842,7 @@ Node parseComplexType(Parser *p) {
 
   // Type is only one word
   if (p->tok.kind == ((T_IDENTIFIER))) {
-    return newNode(N_IDENTIFIER, p->tok.data, p->tok.line, p->sourceName);
+    return newNode(N_IDENTIFIER, tokenText(p), p->tok.line, p->sourceName);
   }
 
   Node out = newNode(N_COMPLEX_TYPE, getString(p->sm, "Complex Type"),
@@ -825,18 +866,18 @@ Node parseComplexType(Parser *p) {
 Node parseValue(Parser *p) {
   switch (p->tok.kind) {
   case T_INT:
-    return newNode(N_INT, p->tok.data, p->tok.line, p->sourceName);
+    return newNode(N_INT, tokenText(p), p->tok.line, p->sourceName);
   case T_FLOAT:
-    return newNode(N_FLOAT, p->tok.data, p->tok.line, p->sourceName);
+    return newNode(N_FLOAT, tokenText(p), p->tok.line, p->sourceName);
   case T_CHAR:
-    return newNode(N_CHAR, p->tok.data, p->tok.line, p->sourceName);
+    return newNode(N_CHAR, tokenText(p), p->tok.line, p->sourceName);
   case T_STRING:
-    return newNode(N_STRING, p->tok.data, p->tok.line, p->sourceName);
+    return newNode(N_STRING, tokenText(p), p->tok.line, p->sourceName);
   case T_IDENTIFIER:
     if (peekToken(p).kind == T_ACCESSOR || peekToken(p).kind == T_P_ACCESSOR) {
       return parseAccess(p);
     }
-    return newNode(N_IDENTIFIER, p->tok.data, p->tok.line, p->sourceName);
+    return newNode(N_IDENTIFIER, tokenText(p), p->tok.line, p->sourceName);
   case T_TRUE:
     return newNode(N_TRUE, NULL, p->tok.line, p->sourceName);
   case T_FALSE:
@@ -860,7 +901,7 @@ Node parseAccess(Parser *p) {
   Node out =
       newNode(N_ACCESS, getString(p->sm, "Access"), p->tok.line, p->sourceName);
 
-  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+  CHECK_APPEND_NEXT(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                     "parseAccess")
 
   if (p->tok.kind == T_ACCESSOR) {
@@ -886,7 +927,7 @@ Node parseAccess(Parser *p) {
     return out;
   }
 
-  CHECK_AND_APPEND(T_IDENTIFIER, "identifier", N_IDENTIFIER, p->tok.data,
+  CHECK_AND_APPEND(T_IDENTIFIER, "identifier", N_IDENTIFIER, tokenText(p),
                    "parseAccess")
 
   return out;
@@ -896,14 +937,14 @@ Node parseSwitchState(Parser *p) {
   Node out = newNode(N_SWITCH_STATE, getString(p->sm, "Switch Statement"),
                      p->tok.line, p->sourceName);
 
-  CHECK_APPEND_NEXT(T_SWITCH, "switch", N_SWITCH, NULL, "parseSwitchStatement")
-  CHECK_APPEND_NEXT(T_L_PAREN, "(", N_L_PAREN, NULL, "parseSwitchStatement")
+  CHECK_NEXT(T_SWITCH, "switch")
+  CHECK_NEXT(T_L_PAREN, "(")
 
   APPEND_STRUCTURE(parseExpression, "parseSwitchStatement");
   nextToken(p);
 
-  CHECK_APPEND_NEXT(T_R_PAREN, ")", N_R_PAREN, NULL, "parseSwitchStatement")
-  CHECK_APPEND_NEXT(T_L_SQUIRLY, "{", N_L_SQUIRLY, NULL, "parseSwitchStatement")
+  CHECK_NEXT(T_R_PAREN, ")")
+  CHECK_NEXT(T_L_SQUIRLY, "{")
 
   while (p->tok.kind == T_CASE) {
     APPEND_STRUCTURE(parseCaseBlock, "parseSwitchStatement");
@@ -915,7 +956,7 @@ Node parseSwitchState(Parser *p) {
     nextToken(p);
   }
 
-  CHECK_AND_APPEND(T_R_SQUIRLY, "}", N_R_SQUIRLY, NULL, "parseSwitchStatement")
+  CHECK_TOK(T_R_SQUIRLY, "}")
 
   return out;
 }
@@ -924,12 +965,12 @@ Node parseCaseBlock(Parser *p) {
   Node out = newNode(N_CASE_BLOCK, getString(p->sm, "Case Block"), p->tok.line,
                      p->sourceName);
 
-  CHECK_APPEND_NEXT(T_CASE, "case", N_CASE, NULL, "parseCaseBlock")
+  CHECK_NEXT(T_CASE, "case")
 
   APPEND_STRUCTURE(parseExpression, "parseCaseBlock");
   nextToken(p);
 
-  CHECK_AND_APPEND(T_COLON, ":", N_COLON, NULL, "parseCaseBlock")
+  CHECK_TOK(T_COLON, ":")
 
   while (peekToken(p).kind != T_CASE && peekToken(p).kind != T_DEFAULT &&
          peekToken(p).kind != T_R_SQUIRLY) {
@@ -977,8 +1018,8 @@ Node parseDefaultBlock(Parser *p) {
   Node out = newNode(N_DEFAULT_BLOCK, getString(p->sm, "Default Block"),
                      p->tok.line, p->sourceName);
 
-  CHECK_APPEND_NEXT(T_DEFAULT, "default", N_DEFAULT, NULL, "parseDefaultBlock")
-  CHECK_AND_APPEND(T_COLON, ":", N_COLON, NULL, "parseDefaultBlock")
+  CHECK_NEXT(T_DEFAULT, "default")
+  CHECK_TOK(T_COLON, ":")
 
   while (peekToken(p).kind != T_R_SQUIRLY) {
     nextToken(p);
@@ -1025,7 +1066,7 @@ Node parseBlock(Parser *p) {
   Node out =
       newNode(N_BLOCK, getString(p->sm, "Block"), p->tok.line, p->sourceName);
 
-  CHECK_APPEND_NEXT(T_L_SQUIRLY, "{", N_L_SQUIRLY, NULL, "parseBlock")
+  CHECK_NEXT(T_L_SQUIRLY, "{")
 
   while (p->tok.kind != T_R_SQUIRLY) {
     switch (p->tok.kind) {
@@ -1066,7 +1107,7 @@ Node parseBlock(Parser *p) {
     nextToken(p);
   }
 
-  CHECK_AND_APPEND(T_R_SQUIRLY, "}", N_R_SQUIRLY, NULL, "parseBlock")
+  CHECK_TOK(T_R_SQUIRLY, "}")
 
   return out;
 }
@@ -1,18 +1,29 @@
 #pragma once
 
+#include "Lexer.h"
 #include "Node.h"
 #include "StringManager.h"
 #include "Token.h"
 
+// How many of the most recently lexed tokens the parser keeps around, must be
+// a power of two
+#define TOKEN_WINDOW 16
+
 typedef struct Parser {
   char *sourceName;
-  TokenList source;
+
+  // Tokens are pulled from the lexer as the parser needs them, and only the
+  // last TOKEN_WINDOW of them are kept
+  Lexer *source;
+  Token window[TOKEN_WINDOW];
+  int lexed; // How many tokens have been pulled from the lexer
+
   Token tok;
   int index;
   Node out;
+  Arena arena; // Holds out, set up by whoever runs the parser
   StringManager *sm;
 } Parser;
 
 void parse(Parser *p);
-void parserInit(Parser *p, char *sourceName, TokenList source,
-                StringManager *sm);
+void parserInit(Parser *p, char *sourceName, Lexer *source, StringManager *sm);
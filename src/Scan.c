@@ -0,0 +1,264 @@
+#include "Scan.h"
+
+#include <stdbool.h>
+#include <threads.h>
+
+#define IS_SPACE(VAL)                                                          \
+  ((VAL) == ' ' || (VAL) == '\t' || (VAL) == '\r' || (VAL) == '\n')
+#define IS_STRING(VAL)                                                         \
+  ((VAL) >= 0 && (VAL) != '"' && (VAL) != '\\' && (VAL) != '\n' &&            \
+   (VAL) != '\r')
+
+// The vector versions only exist on x86-64, where SSE2 is always there and AVX2
+// has to be checked for. Everywhere else only the scalar loops are used
+#if defined(_M_X64) || defined(__x86_64__)
+#define SCAN_SIMD 1
+
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+
+int lowestBit(unsigned int bits) {
+  unsigned long index;
+  _BitScanForward(&index, bits);
+  return index;
+}
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define lowestBit(bits) __builtin_ctz(bits)
+#endif
+
+#endif
+
+bool useAvx2 = false;
+once_flag scanOnce = ONCE_FLAG_INIT;
+
+int countBits(unsigned int bits) {
+  int count = 0;
+
+  while (bits) {
+    bits &= bits - 1;
+    ++count;
+  }
+
+  return count;
+}
+
+void pickScan(void) {
+#ifdef SCAN_SIMD
+#ifdef _MSC_VER
+  int info[4];
+
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return;
+  }
+
+  // The OS has to save the AVX registers too
+  __cpuid(info, 1);
+  if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6) {
+    return;
+  }
+
+  __cpuidex(info, 7, 0);
+  useAvx2 = info[1] & (1 << 5);
+#else
+  useAvx2 = __builtin_cpu_supports("avx2");
+#endif
+#endif
+}
+
+void initScan(void) { call_once(&scanOnce, pickScan); }
+
+#ifdef SCAN_SIMD
+
+// Each of these goes through whole blocks, stopping at the block the run ends
+// in, and leaves whatever is left over to the smaller blocks or the scalar loop
+
+// Takes the mask of bytes that stop the run, and the mask of newlines, adds the
+// newlines before the stop, returns where the stop is, or -1 if there isn't one
+int blockStop(unsigned int stops, unsigned int newlines, int *lines) {
+  if (!stops) {
+    *lines += countBits(newlines);
+    return -1;
+  }
+
+  int at = lowestBit(stops);
+  *lines += countBits(newlines & ((1u << at) - 1));
+  return at;
+}
+
+int spaceSse2(const char *s, int i, int len, int *lines) {
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+    __m128i nl = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+    __m128i ws = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                     _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), nl));
+
+    int at = blockStop(~_mm_movemask_epi8(ws) & 0xFFFF, _mm_movemask_epi8(nl),
+                       lines);
+    if (at >= 0) {
+      return i + at;
+    }
+  }
+
+  return i;
+}
+
+TARGET_AVX2 int spaceAvx2(const char *s, int i, int len, int *lines) {
+  for (; i + 32 <= len; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+    __m256i nl = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'));
+    __m256i ws = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')), nl));
+
+    int at = blockStop(~(unsigned int)_mm256_movemask_epi8(ws),
+                       _mm256_movemask_epi8(nl), lines);
+    if (at >= 0) {
+      return i + at;
+    }
+  }
+
+  return i;
+}
+
+int stringSse2(const char *s, int i, int len) {
+  int lines = 0;
+
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+    __m128i end = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                     _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                     _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+
+    // The top bit of each byte is set for anything past ASCII
+    int at =
+        blockStop(_mm_movemask_epi8(end) | _mm_movemask_epi8(v), 0, &lines);
+    if (at >= 0) {
+      return i + at;
+    }
+  }
+
+  return i;
+}
+
+TARGET_AVX2 int stringAvx2(const char *s, int i, int len) {
+  int lines = 0;
+
+  for (; i + 32 <= len; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+    __m256i end = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+                        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+
+    int at =
+        blockStop(_mm256_movemask_epi8(_mm256_or_si256(end, v)), 0, &lines);
+    if (at >= 0) {
+      return i + at;
+    }
+  }
+
+  return i;
+}
+
+int untilSse2(const char *s, int i, int len, char stop, int *lines) {
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+    __m128i nl = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+    __m128i end = _mm_cmpeq_epi8(v, _mm_set1_epi8(stop));
+
+    int at =
+        blockStop(_mm_movemask_epi8(end), _mm_movemask_epi8(nl), lines);
+    if (at >= 0) {
+      return i + at;
+    }
+  }
+
+  return i;
+}
+
+TARGET_AVX2 int untilAvx2(const char *s, int i, int len, char stop,
+                          int *lines) {
+  for (; i + 32 <= len; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+    __m256i nl = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'));
+    __m256i end = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(stop));
+
+    int at = blockStop(_mm256_movemask_epi8(end), _mm256_movemask_epi8(nl),
+                       lines);
+    if (at >= 0) {
+      return i + at;
+    }
+  }
+
+  return i;
+}
+
+#endif
+
+int scanSpace(const char *s, int from, int len, int *lines) {
+  int i = from;
+
+#ifdef SCAN_SIMD
+  if (useAvx2) {
+    i = spaceAvx2(s, i, len, lines);
+  }
+  i = spaceSse2(s, i, len, lines);
+#endif
+
+  while (i < len && IS_SPACE(s[i])) {
+    if (s[i] == '\n') {
+      ++*lines;
+    }
+    ++i;
+  }
+
+  return i;
+}
+
+int scanString(const char *s, int from, int len) {
+  int i = from;
+
+#ifdef SCAN_SIMD
+  if (useAvx2) {
+    i = stringAvx2(s, i, len);
+  }
+  i = stringSse2(s, i, len);
+#endif
+
+  while (i < len && IS_STRING(s[i])) {
+    ++i;
+  }
+
+  return i;
+}
+
+int scanUntil(const char *s, int from, int len, char stop, int *lines) {
+  int i = from;
+
+#ifdef SCAN_SIMD
+  if (useAvx2) {
+    i = untilAvx2(s, i, len, stop, lines);
+  }
+  i = untilSse2(s, i, len, stop, lines);
+#endif
+
+  while (i < len && s[i] != stop) {
+    if (s[i] == '\n') {
+      ++*lines;
+    }
+    ++i;
+  }
+
+  return i;
+}
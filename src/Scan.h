@@ -0,0 +1,20 @@
+#pragma once
+
+// Measures runs of bytes the lexer would otherwise walk one at a time. Each
+// scan starts at index from of s, and returns the index of the first byte not
+// in the run, or len if the run reaches the end. On x86-64 these look at 16 or
+// 32 bytes at a time, depending on what the CPU supports
+
+// Picks the fastest version of the scans for this CPU, safe to call from any
+// number of threads
+void initScan(void);
+
+// Runs of ' ', '\t', '\r' and '\n', adding the newlines passed to lines
+int scanSpace(const char *s, int from, int len, int *lines);
+
+// Runs of characters that can be copied straight into a string literal, stops
+// at '"', '\\', '\n', '\r' and anything past ASCII
+int scanString(const char *s, int from, int len);
+
+// Runs up to the next stop, adding the newlines passed to lines
+int scanUntil(const char *s, int from, int len, char stop, int *lines);
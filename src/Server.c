@@ -0,0 +1,307 @@
+#include "Server.h"
+
+#ifdef _WIN32
+
+#include <stdio.h>
+
+int runServer(char *socketPath) {
+  printf("The compile server isn't supported on Windows\n");
+  return 1;
+}
+
+int runClient(char *socketPath, int argc, char *argv[]) {
+  printf("The compile server isn't supported on Windows\n");
+  return 1;
+}
+
+#else
+
+#include "Compile.h"
+#include "Incremental.h"
+#include "Panic.h"
+#include "Stats.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Largest request a client can send, the arguments joined together
+#define MAX_REQUEST (1 << 20)
+
+// Sent along with a request, in this order
+#define REQUEST_FDS 3
+#define FD_CWD 0
+#define FD_STDOUT 1
+#define FD_STDERR 2
+
+// The same as a compile from main, except only the files that changed since
+// they were last seen are parsed
+int compileRequest(Incremental *inc, int argc, char *argv[]) {
+  char *fileNames[argc];
+  Options o = {fileNames};
+  if (readOptions(&o, argc, argv)) {
+    return 1;
+  }
+
+  // Both are written once the process ends, which the server never does
+  int status = 1;
+  if (o.traceName != NULL || statsEnabled) {
+    statsEnabled = false;
+    printf("--trace and --stats can't be used through the server\n");
+  } else if (!validateFiles(&o)) {
+    status = incrementalCompile(inc, &o);
+  }
+
+  // The back end wrote to it in another process, this one only has to let go
+  if (o.outStream != NULL) {
+    fclose(o.outStream);
+  }
+
+  return status;
+}
+
+// Reads exactly len bytes, returns non-zero if the connection closed first
+errno_t readAll(int fd, char *buf, int len) {
+  while (len > 0) {
+    ssize_t got = read(fd, buf, len);
+    if (got <= 0) {
+      return 1;
+    }
+    buf += got;
+    len -= got;
+  }
+
+  return 0;
+}
+
+errno_t writeAll(int fd, char *buf, int len) {
+  while (len > 0) {
+    ssize_t put = write(fd, buf, len);
+    if (put <= 0) {
+      return 1;
+    }
+    buf += put;
+    len -= put;
+  }
+
+  return 0;
+}
+
+// A request is the length of the arguments, sent with the client's
+// descriptors, then the arguments, each ending in a NUL
+errno_t receiveRequest(int conn, int fds[REQUEST_FDS], char **data, int *len) {
+  char control[CMSG_SPACE(sizeof(int) * REQUEST_FDS)];
+  struct iovec iov = {len, sizeof(int)};
+  struct msghdr msg = {0};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  if (recvmsg(conn, &msg, MSG_WAITALL) != sizeof(int)) {
+    return 1;
+  }
+
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET ||
+      cmsg->cmsg_type != SCM_RIGHTS ||
+      cmsg->cmsg_len != CMSG_LEN(sizeof(int) * REQUEST_FDS)) {
+    return 1;
+  }
+  memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * REQUEST_FDS);
+
+  if (*len >= 0 && *len <= MAX_REQUEST &&
+      (*data = malloc(*len + 1)) != NULL) {
+    if (!readAll(conn, *data, *len)) {
+      (*data)[*len] = 0;
+      return 0;
+    }
+    free(*data);
+  }
+
+  for (int i = 0; i < REQUEST_FDS; ++i) {
+    close(fds[i]);
+  }
+  return 1;
+}
+
+void handleRequest(Incremental *inc, int conn) {
+  int fds[REQUEST_FDS];
+  char *data;
+  int len;
+  if (receiveRequest(conn, fds, &data, &len)) {
+    return;
+  }
+
+  // argv[0] is skipped by readOptions, the same as in main
+  int argc = 1;
+  for (int i = 0; i < len; ++i) {
+    argc += data[i] == 0;
+  }
+
+  char *argv[argc + 1];
+  argv[0] = "nav";
+  char *arg = data;
+  for (int i = 1; i < argc; ++i) {
+    argv[i] = arg;
+    arg += strlen(arg) + 1;
+  }
+  argv[argc] = NULL;
+
+  // Compile as if the server had been started where the client was
+  fflush(stdout);
+  fflush(stderr);
+  int savedOut = dup(STDOUT_FILENO);
+  int savedErr = dup(STDERR_FILENO);
+  unsigned char status = 1;
+
+  if (!fchdir(fds[FD_CWD]) && dup2(fds[FD_STDOUT], STDOUT_FILENO) >= 0 &&
+      dup2(fds[FD_STDERR], STDERR_FILENO) >= 0) {
+    status = compileRequest(inc, argc, argv);
+  }
+
+  fflush(stdout);
+  fflush(stderr);
+  dup2(savedOut, STDOUT_FILENO);
+  dup2(savedErr, STDERR_FILENO);
+  close(savedOut);
+  close(savedErr);
+
+  for (int i = 0; i < REQUEST_FDS; ++i) {
+    close(fds[i]);
+  }
+  free(data);
+
+  writeAll(conn, (char *)&status, 1);
+}
+
+errno_t socketAddress(struct sockaddr_un *addr, char *socketPath) {
+  memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+
+  if (strlen(socketPath) >= sizeof(addr->sun_path)) {
+    printf("Socket path %s is too long\n", socketPath);
+    return 1;
+  }
+  strcpy(addr->sun_path, socketPath);
+
+  return 0;
+}
+
+int runServer(char *socketPath) {
+  struct sockaddr_un addr;
+  if (socketAddress(&addr, socketPath)) {
+    return 1;
+  }
+
+  Incremental inc;
+  if (incrementalInit(&inc)) {
+    printf("Couldn't load string manager\n");
+    return 1;
+  }
+
+  // A client going away mid compile shouldn't take the server with it
+  signal(SIGPIPE, SIG_IGN);
+
+  // Left behind if the last server was killed
+  unlink(socketPath);
+
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0 || bind(listener, (struct sockaddr *)&addr, sizeof(addr)) ||
+      listen(listener, 16)) {
+    printf("Couldn't listen on %s\n", socketPath);
+    return 1;
+  }
+
+  printf("Listening on %s\n", socketPath);
+  fflush(stdout);
+
+  // One compile at a time, they all share the cache
+  while (true) {
+    int conn = accept(listener, NULL, NULL);
+    if (conn < 0) {
+      continue;
+    }
+
+    handleRequest(&inc, conn);
+    close(conn);
+  }
+}
+
+int runClient(char *socketPath, int argc, char *argv[]) {
+  struct sockaddr_un addr;
+  if (socketAddress(&addr, socketPath)) {
+    return 1;
+  }
+
+  int conn = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (conn < 0 || connect(conn, (struct sockaddr *)&addr, sizeof(addr))) {
+    printf("Couldn't connect to a server on %s\n", socketPath);
+    return 1;
+  }
+
+  int len = 0;
+  for (int i = 0; i < argc; ++i) {
+    len += strlen(argv[i]) + 1;
+  }
+
+  char *data = malloc(len > 0 ? len : 1);
+  if (data == NULL) {
+    panic("Couldn't allocate the request");
+  }
+
+  char *arg = data;
+  for (int i = 0; i < argc; ++i) {
+    int argLen = strlen(argv[i]) + 1;
+    memcpy(arg, argv[i], argLen);
+    arg += argLen;
+  }
+
+  int fds[REQUEST_FDS];
+  fds[FD_CWD] = open(".", O_RDONLY | O_DIRECTORY);
+  fds[FD_STDOUT] = STDOUT_FILENO;
+  fds[FD_STDERR] = STDERR_FILENO;
+  if (fds[FD_CWD] < 0) {
+    printf("Couldn't open the current directory\n");
+    return 1;
+  }
+
+  char control[CMSG_SPACE(sizeof(int) * REQUEST_FDS)];
+  memset(control, 0, sizeof(control));
+  struct iovec iov = {&len, sizeof(int)};
+  struct msghdr msg = {0};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int) * REQUEST_FDS);
+  memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * REQUEST_FDS);
+
+  // Anything the client printed has to come out before the compile's output
+  fflush(stdout);
+  fflush(stderr);
+
+  unsigned char status;
+  if (sendmsg(conn, &msg, 0) != sizeof(int) || writeAll(conn, data, len) ||
+      readAll(conn, (char *)&status, 1)) {
+    printf("Lost the connection to the server\n");
+    status = 1;
+  }
+
+  close(fds[FD_CWD]);
+  close(conn);
+  free(data);
+  return status;
+}
+
+#endif
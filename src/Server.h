@@ -0,0 +1,14 @@
+#pragma once
+
+// A compile server keeps the string manager and every file's parse tree
+// between compiles, only files whose contents changed get parsed again.
+// Clients hand over their working directory, stdout and stderr along with the
+// arguments, so a compile through the server looks the same as one without.
+// Only available where there are Unix domain sockets and fork
+
+// Listens on the socket until killed, returns non-zero if it couldn't start
+int runServer(char *socketPath);
+
+// Sends the arguments to the server and waits for the compile to finish,
+// returns the compile's exit code
+int runClient(char *socketPath, int argc, char *argv[]);
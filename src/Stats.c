@@ -0,0 +1,124 @@
+#include "Stats.h"
+#include "Node.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// N_STRING is the last node code
+#define NODE_CODE_COUNT (N_STRING + 1)
+
+typedef struct AllocStats {
+  atomic_llong bytes;  // Currently allocated
+  atomic_llong peak;   // Most ever allocated at once
+  atomic_llong allocs; // Number of allocations
+  atomic_llong total;  // Bytes ever allocated
+} AllocStats;
+
+bool statsEnabled = false;
+
+AllocStats allocStats[SUBSYSTEM_COUNT];
+atomic_llong counters[COUNTER_COUNT];
+atomic_llong maximums[MAXIMUM_COUNT];
+atomic_llong nodeCounts[NODE_CODE_COUNT];
+
+// Raises a high water mark, other threads might be raising it at the same time
+void raiseTo(atomic_llong *mark, long long n) {
+  long long cur = atomic_load_explicit(mark, memory_order_relaxed);
+  while (n > cur && !atomic_compare_exchange_weak_explicit(
+                        mark, &cur, n, memory_order_relaxed,
+                        memory_order_relaxed)) {
+  }
+}
+
+void statAlloc(Subsystem s, long long bytes) {
+  AllocStats *a = allocStats + s;
+  atomic_fetch_add_explicit(&a->allocs, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&a->total, bytes, memory_order_relaxed);
+  raiseTo(&a->peak,
+          atomic_fetch_add_explicit(&a->bytes, bytes, memory_order_relaxed) +
+              bytes);
+}
+
+void statFree(Subsystem s, long long bytes) {
+  atomic_fetch_sub_explicit(&allocStats[s].bytes, bytes, memory_order_relaxed);
+}
+
+void statCount(Counter c, long long n) {
+  atomic_fetch_add_explicit(counters + c, n, memory_order_relaxed);
+}
+
+void statMax(Maximum m, long long n) { raiseTo(maximums + m, n); }
+
+void statNode(int kind) {
+  atomic_fetch_add_explicit(nodeCounts + kind, 1, memory_order_relaxed);
+}
+
+char *subsystemString(Subsystem s) {
+  switch (s) {
+  case SUB_SOURCE:
+    return "Source";
+  case SUB_NODES:
+    return "Nodes";
+  case SUB_STRINGS:
+    return "Strings";
+  case SUB_ANALYSER:
+    return "Analyser";
+  case SUB_CHARS:
+    return "Chars";
+  case SUB_OPTIMISER:
+    return "Optimiser";
+
+  default:
+    return "UNKNOWN";
+  }
+}
+
+long long loadStat(atomic_llong *stat) {
+  return atomic_load_explicit(stat, memory_order_relaxed);
+}
+
+void printStats(void) {
+  printf("\nAllocations\n");
+  printf("%-12s %12s %14s %14s %14s\n", "Subsystem", "Allocs", "Total bytes",
+         "Peak bytes", "Live bytes");
+  for (int i = 0; i < SUBSYSTEM_COUNT; ++i) {
+    AllocStats *a = allocStats + i;
+    printf("%-12s %12lld %14lld %14lld %14lld\n", subsystemString(i),
+           loadStat(&a->allocs), loadStat(&a->total), loadStat(&a->peak),
+           loadStat(&a->bytes));
+  }
+
+  long long lookups = loadStat(counters + COUNT_STRING_LOOKUPS);
+  long long hits = loadStat(counters + COUNT_STRING_HITS);
+  long long scopeLookups = loadStat(counters + COUNT_SCOPE_LOOKUPS);
+
+  printf("\nCounters\n");
+  printf("Tokens lexed:            %lld\n", loadStat(counters + COUNT_TOKENS));
+  printf("Interned strings:        %lld\n", lookups - hits);
+  printf("String lookups:          %lld\n", lookups);
+  printf("String hit rate:         %.1f%%\n",
+         lookups ? 100.0 * hits / lookups : 0.0);
+  printf("String probes:           %lld (longest %lld)\n",
+         loadStat(counters + COUNT_STRING_PROBES),
+         loadStat(maximums + MAX_STRING_PROBE));
+  printf("Scope lookups:           %lld\n", scopeLookups);
+  printf("Scope probes:            %lld (average %.1f, longest %lld)\n",
+         loadStat(counters + COUNT_SCOPE_PROBES),
+         scopeLookups ? (double)loadStat(counters + COUNT_SCOPE_PROBES) /
+                            scopeLookups
+                      : 0.0,
+         loadStat(maximums + MAX_SCOPE_PROBE));
+  printf("AST cache hits:          %lld of %lld\n",
+         loadStat(counters + COUNT_CACHE_HITS),
+         loadStat(counters + COUNT_CACHE_HITS) +
+             loadStat(counters + COUNT_CACHE_MISSES));
+
+  printf("\nNodes created\n");
+  for (int i = 0; i < NODE_CODE_COUNT; ++i) {
+    long long count = loadStat(nodeCounts + i);
+    if (count) {
+      printf("%-24s %lld\n", nodeCodeString(i), count);
+    }
+  }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdbool.h>
+
+// Counts allocations and other events inside the compiler, printed with
+// --stats. Nothing is counted unless statsEnabled is set, so the cost when it
+// isn't is a single branch
+
+// Where memory is allocated
+typedef enum Subsystem {
+  SUB_SOURCE,    // Source files read by the lexer
+  SUB_NODES,     // Node arenas, trees and child lists
+  SUB_STRINGS,   // String manager chunks and indexes
+  SUB_ANALYSER,  // The analyser's arena, its identifiers, types and functions
+  SUB_CHARS,     // Char lists, typeString and the emitted output
+  SUB_OPTIMISER, // Optimiser bookkeeping
+  SUBSYSTEM_COUNT,
+} Subsystem;
+
+// Things that happen often enough to be worth counting
+typedef enum Counter {
+  COUNT_TOKENS,          // Tokens lexed
+  COUNT_STRING_LOOKUPS,  // Calls to getSymbol/getString
+  COUNT_STRING_HITS,     // Lookups that found an interned string
+  COUNT_STRING_PROBES,   // Slots checked by string lookups
+  COUNT_SCOPE_LOOKUPS,   // Variable, function and type lookups in the analyser
+  COUNT_SCOPE_PROBES,    // Stack entries checked by those lookups
+  COUNT_CACHE_HITS,      // Files loaded from the AST cache
+  COUNT_CACHE_MISSES,    // Files parsed with the AST cache on
+  COUNTER_COUNT,
+} Counter;
+
+// Counters that keep the largest value seen
+typedef enum Maximum {
+  MAX_STRING_PROBE, // Longest string lookup
+  MAX_SCOPE_PROBE,  // Longest analyser lookup
+  MAXIMUM_COUNT,
+} Maximum;
+
+extern bool statsEnabled;
+
+#define STAT_ALLOC(subsystem, bytes)                                           \
+  if (statsEnabled) {                                                          \
+    statAlloc((subsystem), (bytes));                                           \
+  }
+
+#define STAT_FREE(subsystem, bytes)                                            \
+  if (statsEnabled) {                                                          \
+    statFree((subsystem), (bytes));                                            \
+  }
+
+#define STAT_COUNT(counter, n)                                                 \
+  if (statsEnabled) {                                                          \
+    statCount((counter), (n));                                                 \
+  }
+
+#define STAT_MAX(maximum, n)                                                   \
+  if (statsEnabled) {                                                          \
+    statMax((maximum), (n));                                                   \
+  }
+
+#define STAT_NODE(kind)                                                        \
+  if (statsEnabled) {                                                          \
+    statNode(kind);                                                            \
+  }
+
+// Safe to call from any thread, use the macros above rather than these
+void statAlloc(Subsystem s, long long bytes);
+void statFree(Subsystem s, long long bytes);
+void statCount(Counter c, long long n);
+void statMax(Maximum m, long long n);
+void statNode(int kind);
+
+// Prints everything counted so far
+void printStats(void);
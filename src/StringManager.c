@@ -1,81 +1,284 @@
 #include "StringManager.h"
+#include "Stats.h"
 
 #include <corecrt.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// A megabyte dedicate to string storage
-#define MAX_BULK 1000000
+// Bytes of string data in a regular chunk, strings longer than this get a
+// chunk of their own
+#define CHUNK_SIZE 4096
 
-// Maximum hundred thousand unique strings
-#define MAX_STRINGS 100000
+// Starting number of slots in each shard's hash index, must be a power of two.
+// The index is kept at most half full so that probe sequences stay short
+#define INITIAL_INDEX_SIZE 64
+
+// Shards are picked with the top bits of the hash, slots with the bottom bits.
+// The shift has to leave exactly enough bits to count the shards, so it must
+// change with STRING_SHARDS
+#define SHARD_SHIFT 28
+
+_Static_assert((STRING_SHARDS & (STRING_SHARDS - 1)) == 0,
+               "STRING_SHARDS must be a power of two");
+_Static_assert(STRING_SHARDS ==
+                   1ull << (sizeof(unsigned int) * CHAR_BIT - SHARD_SHIFT),
+               "SHARD_SHIFT doesn't match STRING_SHARDS");
+
+StringIndex *newStringIndex(int size) {
+  StringIndex *index = calloc(1, sizeof(StringIndex) + size * sizeof(char *));
+  if (index == NULL) {
+    return NULL;
+  }
+  STAT_ALLOC(SUB_STRINGS, sizeof(StringIndex) + size * sizeof(char *))
+
+  index->mask = size - 1;
+  index->retired = NULL;
+
+  return index;
+}
 
 errno_t initStringManager(StringManager *sm) {
-  // Allocate bulk memory
-  sm->bulk = calloc(MAX_BULK, sizeof(char));
-  if (sm->bulk == NULL) {
-    return 1;
+  for (int i = 0; i < STRING_SHARDS; ++i) {
+    StringShard *shard = sm->shards + i;
+
+    if (mtx_init(&shard->lock, mtx_plain) != thrd_success) {
+      return 1;
+    }
+
+    // Allocate the index, all slots start empty
+    StringIndex *index = newStringIndex(INITIAL_INDEX_SIZE);
+    if (index == NULL) {
+      return 1;
+    }
+    atomic_init(&shard->index, index);
+    shard->count = 0;
+
+    // Chunks are only allocated once there's a string to store
+    shard->chunks = NULL;
+    shard->regNext = NULL;
+    shard->regEnd = NULL;
+  }
+
+  return 0;
+}
+
+void destroyStringManager(StringManager *sm) {
+  for (int i = 0; i < STRING_SHARDS; ++i) {
+    StringShard *shard = sm->shards + i;
+
+    StringChunk *chunk = shard->chunks;
+    while (chunk != NULL) {
+      StringChunk *prev = chunk->prev;
+      STAT_FREE(SUB_STRINGS, sizeof(StringChunk) + chunk->size)
+      free(chunk);
+      chunk = prev;
+    }
+
+    StringIndex *index = atomic_load(&shard->index);
+    while (index != NULL) {
+      StringIndex *retired = index->retired;
+      STAT_FREE(SUB_STRINGS,
+                sizeof(StringIndex) + (index->mask + 1) * sizeof(char *))
+      free(index);
+      index = retired;
+    }
+
+    mtx_destroy(&shard->lock);
+  }
+}
+
+unsigned int hashSlice(const char *str, int len) {
+  unsigned int hash = HASH_INIT;
+
+  for (int i = 0; i < len; ++i) {
+    hash = HASH_STEP(hash, str[i]);
+  }
+
+  return hash;
+}
+
+// Looks for this string in the index, if it isn't there slot is set to the
+// empty slot it should go in
+char *findString(StringIndex *index, const char *str, int len,
+                 unsigned int hash, int *slot) {
+  int cur = hash & index->mask;
+  int probes = 1;
+  char *found;
+
+  while ((found = atomic_load_explicit(index->slots + cur,
+                                       memory_order_acquire)) != NULL) {
+    SymbolHeader *header = (SymbolHeader *)found - 1;
+
+    if (header->hash == hash && header->len == len &&
+        !memcmp(found, str, len)) {
+      break;
+    }
+
+    cur = (cur + 1) & index->mask;
+    ++probes;
+  }
+
+  STAT_COUNT(COUNT_STRING_PROBES, probes)
+  STAT_MAX(MAX_STRING_PROBE, probes)
+
+  *slot = cur;
+  return found;
+}
+
+// Doubles the shard's index, the caller must hold the shard's lock
+StringIndex *growIndex(StringShard *shard, StringIndex *old) {
+  StringIndex *index = newStringIndex((old->mask + 1) * 2);
+  if (index == NULL) {
+    return NULL;
+  }
+
+  for (int i = 0; i <= old->mask; ++i) {
+    char *cur = atomic_load_explicit(old->slots + i, memory_order_relaxed);
+    if (cur == NULL) {
+      continue;
+    }
+
+    int slot = ((SymbolHeader *)cur - 1)->hash & index->mask;
+    while (atomic_load_explicit(index->slots + slot, memory_order_relaxed)) {
+      slot = (slot + 1) & index->mask;
+    }
+
+    atomic_store_explicit(index->slots + slot, cur, memory_order_relaxed);
+  }
+
+  // Readers may still be probing the old index
+  index->retired = old;
+  atomic_store_explicit(&shard->index, index, memory_order_release);
+
+  return index;
+}
+
+// Makes sure there's room for size bytes in the newest chunk, keeping regNext
+// aligned for the header that goes in front of each string
+errno_t reserveBulk(StringShard *shard, int size) {
+  if (shard->regNext != NULL) {
+    size_t misalign = (size_t)shard->regNext % _Alignof(SymbolHeader);
+    if (misalign) {
+      shard->regNext += _Alignof(SymbolHeader) - misalign;
+    }
+
+    if (shard->regEnd - shard->regNext >= size) {
+      return 0;
+    }
   }
 
-  // Allocate registry
-  sm->registry = malloc(MAX_STRINGS * sizeof(char *));
-  if (sm->registry == NULL) {
+  int chunkSize = size > CHUNK_SIZE ? size : CHUNK_SIZE;
+
+  StringChunk *chunk = malloc(sizeof(StringChunk) + chunkSize);
+  if (chunk == NULL) {
     return 1;
   }
+  STAT_ALLOC(SUB_STRINGS, sizeof(StringChunk) + chunkSize)
 
-  sm->regCount = 0;
-  sm->regNext = sm->bulk;
+  chunk->prev = shard->chunks;
+  chunk->size = chunkSize;
+  shard->chunks = chunk;
+  shard->regNext = chunk->data;
+  shard->regEnd = chunk->data + chunkSize;
 
   return 0;
 }
 
-void destroyStringManager(StringManager *sm) {
-  free(sm->registry);
-  free(sm->bulk);
+Symbol getSymbol(StringManager *sm, const char *str, int len) {
+  return getSymbolHashed(sm, str, len, hashSlice(str, len));
 }
 
-// getString hard errors if no string can be returned.
-// For this to occur, no match will be found.
-// Furthermore, the string manager will have the inability to
-// allocate a new string.
-char *getString(StringManager *sm, const char *match) {
-  // Check current registry
-  int x = sm->regCount;
-  // printf("Checking for match %s\n", match);
-
-  for (int i = 0; i < sm->regCount; ++i) {
-    printf("%s\n", sm->registry[i]);
-    if (!strcmp(sm->registry[i], match)) {
-      return sm->registry[i];
-    }
+Symbol getSymbolHashed(StringManager *sm, const char *str, int len,
+                       unsigned int hash) {
+  StringShard *shard = sm->shards + (hash >> SHARD_SHIFT);
+
+  STAT_COUNT(COUNT_STRING_LOOKUPS, 1)
+
+  // Check current registry without locking
+  StringIndex *index =
+      atomic_load_explicit(&shard->index, memory_order_acquire);
+  int slot;
+  char *found = findString(index, str, len, hash, &slot);
+  if (found != NULL) {
+    STAT_COUNT(COUNT_STRING_HITS, 1)
+    return (Symbol){found, len, hash};
   }
 
-  // Couldn't find it, attempt to add it to the registry
-  int matchLength = strlen(match);
-  if (sm->regNext - sm->bulk + matchLength > MAX_BULK) {
+  // Couldn't find it, check again under the lock in case another thread
+  // added it (or grew the index) in the meantime
+  mtx_lock(&shard->lock);
+
+  index = atomic_load_explicit(&shard->index, memory_order_relaxed);
+  found = findString(index, str, len, hash, &slot);
+  if (found != NULL) {
+    mtx_unlock(&shard->lock);
+    STAT_COUNT(COUNT_STRING_HITS, 1)
+    return (Symbol){found, len, hash};
+  }
+
+  // Still not there, attempt to add it to the registry
+  if (reserveBulk(shard, sizeof(SymbolHeader) + len + 1)) {
     // Hard error, out of room
-    printf(
-        "Ran out of room to allocate for strings, attempting to allocate %s\n",
-        match);
+    printf("Ran out of room to allocate for strings, attempting to allocate "
+           "%.*s\n",
+           len, str);
     exit(1);
-    return NULL;
   }
 
-  sm->registry[sm->regCount] = sm->regNext;
-  ++sm->regCount;
+  // Header first, then the string itself
+  *(SymbolHeader *)shard->regNext = (SymbolHeader){hash, len};
+  shard->regNext += sizeof(SymbolHeader);
 
-  for (int i = 0; i < matchLength; ++i) {
-    *sm->regNext = match[i];
-    ++sm->regNext;
-  }
+  found = shard->regNext;
+
+  memcpy(shard->regNext, str, len);
+  shard->regNext += len;
 
   // Add that line terminator!
-  *sm->regNext = 0;
-  sm->regNext++;
+  *shard->regNext = 0;
+  shard->regNext++;
+
+  ++shard->count;
+
+  // Keep the index at most half full
+  if (shard->count * 2 > index->mask + 1) {
+    index = growIndex(shard, index);
+    if (index == NULL) {
+      printf("Ran out of room to index strings, attempting to allocate "
+             "%.*s\n",
+             len, str);
+      exit(1);
+    }
+    findString(index, str, len, hash, &slot);
+  }
+
+  // Publishing the slot makes the string visible to lock free readers, so it
+  // has to come after the string is written
+  atomic_store_explicit(index->slots + slot, found, memory_order_release);
+
+  mtx_unlock(&shard->lock);
+
+  return (Symbol){found, len, hash};
+}
+
+// getString hard errors if no string can be returned.
+// For this to occur, no match will be found.
+// Furthermore, the string manager will have the inability to
+// allocate a new string.
+char *getString(StringManager *sm, const char *match) {
+  return getSymbol(sm, match, strlen(match)).str;
+}
+
+Symbol symbolOf(const char *interned) {
+  SymbolHeader *header = (SymbolHeader *)interned - 1;
+  return (Symbol){(char *)interned, header->len, header->hash};
+}
 
-  return sm->registry[sm->regCount - 1];
+int symbolLen(const char *interned) {
+  return ((SymbolHeader *)interned - 1)->len;
 }
 
 bool cmpStr(const char *a, const char *b) {
@@ -1,27 +1,102 @@
 #pragma once
 
 #include <corecrt.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <threads.h>
 
-typedef struct StringManager {
-  // Keeps track of all string
-  char **registry;
-  int regCount;
+// A handle to an interned string. Two symbols from the same string manager are
+// the same string exactly when their str pointers are the same
+typedef struct Symbol {
+  char *str;
+  int len;
+  unsigned int hash;
+} Symbol;
+
+// Every interned string is stored right after one of these, so the length and
+// hash of any interned char * can be recovered without walking it
+typedef struct SymbolHeader {
+  unsigned int hash;
+  int len;
+} SymbolHeader;
+
+// Strings live in a linked list of chunks. A chunk is never moved or resized
+// once it's allocated, so interned pointers stay valid as more are added
+typedef struct StringChunk StringChunk;
+
+typedef struct StringChunk {
+  StringChunk *prev;
+  int size; // Bytes in data
+  char data[];
+} StringChunk;
+
+// Open addressing hash index of interned strings. Slots are read without
+// locking, so when an index grows the old one is kept (retired) until the
+// string manager is destroyed, in case another thread is still probing it
+typedef struct StringIndex StringIndex;
 
-  // Where all string data is stored
-  char *bulk;
+typedef struct StringIndex {
+  int mask;
+  StringIndex *retired;
+  _Atomic(char *) slots[];
+} StringIndex;
+
+// Each shard owns the strings whose hash lands in it. Lookups of strings that
+// already exist never take the lock, inserts lock only their own shard
+typedef struct StringShard {
+  mtx_t lock;
+  _Atomic(StringIndex *) index;
+  int count;
+
+  // Where this shard's string data is stored, regNext and regEnd bound the
+  // free space left in the newest chunk
+  StringChunk *chunks;
   char *regNext;
+  char *regEnd;
+} StringShard;
+
+// Must be a power of two, and SHARD_SHIFT in StringManager.c has to match it
+#define STRING_SHARDS 16
+
+// The string manager is safe to share between threads
+typedef struct StringManager {
+  StringShard shards[STRING_SHARDS];
 } StringManager;
 
+// Compares two strings from the same string manager
+#define SAME_SYMBOL(a, b) ((a) == (b))
+
 errno_t initStringManager(StringManager *sm);
 
 void destroyStringManager(StringManager *sm);
 
+// The hash the string manager uses (FNV-1a), exposed so that callers already
+// walking a string can hash it as they go
+#define HASH_INIT 2166136261u
+#define HASH_STEP(hash, c) (((hash) ^ (unsigned char)(c)) * 16777619u)
+
+// Hashes len bytes of str, this is the hash the string manager uses
+unsigned int hashSlice(const char *str, int len);
+
+// Interns len bytes of str, which doesn't need to be null terminated.
+// Hard errors the same way as getString.
+Symbol getSymbol(StringManager *sm, const char *str, int len);
+
+// The same as getSymbol, for when hashSlice(str, len) is already known
+Symbol getSymbolHashed(StringManager *sm, const char *str, int len,
+                       unsigned int hash);
+
 // getString hard errors if no string can be returned.
 // For this to occur, no match will be found.
 // Furthermore, the string manager will have the inability to
 // allocate a new string.
 char *getString(StringManager *sm, const char *match);
 
+// Gets the symbol of a string that was returned by a string manager
+Symbol symbolOf(const char *interned);
+
+// Gets the length of a string that was returned by a string manager
+int symbolLen(const char *interned);
+
 // Returns true if the strings are the same
 bool cmpStr(const char *a, const char *b);
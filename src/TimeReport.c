@@ -0,0 +1,201 @@
+#include "TimeReport.h"
+#include "Panic.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include <psapi.h>
+
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+
+double wallSeconds(void) {
+  LARGE_INTEGER freq;
+  LARGE_INTEGER count;
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&count);
+  return (double)count.QuadPart / freq.QuadPart;
+}
+
+double cpuSeconds(bool thread) {
+  FILETIME create, exited, kernel, user;
+  BOOL ok;
+
+  if (thread) {
+    ok = GetThreadTimes(GetCurrentThread(), &create, &exited, &kernel, &user);
+  } else {
+    ok = GetProcessTimes(GetCurrentProcess(), &create, &exited, &kernel, &user);
+  }
+  if (!ok) {
+    return 0;
+  }
+
+  // Both are in 100ns ticks
+  ULARGE_INTEGER k = {.LowPart = kernel.dwLowDateTime,
+                      .HighPart = kernel.dwHighDateTime};
+  ULARGE_INTEGER u = {.LowPart = user.dwLowDateTime,
+                      .HighPart = user.dwHighDateTime};
+  return (k.QuadPart + u.QuadPart) * 1e-7;
+}
+
+long long peakRss(void) {
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+    return 0;
+  }
+  return pmc.PeakWorkingSetSize;
+}
+#else
+#include <sys/resource.h>
+#include <time.h>
+
+double clockSeconds(clockid_t clock) {
+  struct timespec ts;
+  if (clock_gettime(clock, &ts)) {
+    return 0;
+  }
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+double wallSeconds(void) { return clockSeconds(CLOCK_MONOTONIC); }
+
+double cpuSeconds(bool thread) {
+  return clockSeconds(thread ? CLOCK_THREAD_CPUTIME_ID
+                             : CLOCK_PROCESS_CPUTIME_ID);
+}
+
+long long peakRss(void) {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage)) {
+    return 0;
+  }
+
+  // macOS gives bytes, everything else gives KiB
+#ifdef __APPLE__
+  return usage.ru_maxrss;
+#else
+  return usage.ru_maxrss * 1024LL;
+#endif
+}
+#endif
+
+// Whole program phases, there are only a handful of them
+#define PHASE_SLOTS 16
+
+errno_t timeReportInit(TimeReport *r, ReportFormat format, int fileCount) {
+  r->format = format;
+  r->fileCount = fileCount;
+  r->len = fileCount;
+  r->cap = fileCount + PHASE_SLOTS;
+  r->phases = NULL;
+
+  if (format == REPORT_NONE) {
+    return 0;
+  }
+
+  r->phases = calloc(r->cap, sizeof(PhaseTime));
+  if (r->phases == NULL) {
+    return 1;
+  }
+
+  return 0;
+}
+
+void timeReportDestroy(TimeReport *r) { free(r->phases); }
+
+Stopwatch startStopwatch(TimeReport *r, bool thread) {
+  if (r->format == REPORT_NONE) {
+    return (Stopwatch){0, 0, thread};
+  }
+
+  return (Stopwatch){wallSeconds(), cpuSeconds(thread), thread};
+}
+
+PhaseTime stopStopwatch(Stopwatch start, char *phase, char *file) {
+  return (PhaseTime){phase, file, wallSeconds() - start.wall,
+                     cpuSeconds(start.thread) - start.cpu, peakRss()};
+}
+
+void endPhase(TimeReport *r, Stopwatch start, char *phase) {
+  if (r->format == REPORT_NONE) {
+    return;
+  }
+
+  if (r->len == r->cap) {
+    panic("Too many phases in the time report");
+  }
+
+  r->phases[r->len] = stopStopwatch(start, phase, NULL);
+  ++r->len;
+}
+
+void endFilePhase(TimeReport *r, Stopwatch start, char *phase, int fileIndex,
+                  char *fileName) {
+  if (r->format == REPORT_NONE) {
+    return;
+  }
+
+  r->phases[fileIndex] = stopStopwatch(start, phase, fileName);
+}
+
+void printJsonString(FILE *f, char *str) {
+  fputc('"', f);
+  for (; *str; ++str) {
+    switch (*str) {
+    case '"':
+    case '\\':
+      fputc('\\', f);
+      fputc(*str, f);
+      break;
+    default:
+      if ((unsigned char)*str < 0x20) {
+        fprintf(f, "\\u%04x", *str);
+      } else {
+        fputc(*str, f);
+      }
+    }
+  }
+  fputc('"', f);
+}
+
+void printTimeReport(TimeReport *r) {
+  switch (r->format) {
+  case REPORT_NONE:
+    return;
+
+  case REPORT_TABLE:
+    fprintf(stderr, "%-20s %-24s %12s %12s %16s\n", "Phase", "File",
+            "Wall (ms)", "CPU (ms)", "Peak RSS (KiB)");
+    for (int i = 0; i < r->len; ++i) {
+      PhaseTime *t = &r->phases[i];
+      fprintf(stderr, "%-20s %-24s %12.3f %12.3f %16lld\n", t->phase,
+              t->file ? t->file : "(all)", t->wall * 1e3, t->cpu * 1e3,
+              t->peakRss / 1024);
+    }
+    return;
+
+  case REPORT_JSON:
+    fprintf(stderr, "{\"phases\": [");
+    for (int i = 0; i < r->len; ++i) {
+      PhaseTime *t = &r->phases[i];
+      fprintf(stderr, "%s\n  {\"phase\": ", i ? "," : "");
+      printJsonString(stderr, t->phase);
+      fprintf(stderr, ", \"file\": ");
+      if (t->file) {
+        printJsonString(stderr, t->file);
+      } else {
+        fprintf(stderr, "null");
+      }
+      fprintf(stderr,
+              ", \"wallMs\": %.3f, \"cpuMs\": %.3f, \"peakRssBytes\": %lld}",
+              t->wall * 1e3, t->cpu * 1e3, t->peakRss);
+    }
+    fprintf(stderr, "\n]}\n");
+    return;
+  }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <corecrt.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+typedef enum ReportFormat {
+  REPORT_NONE,
+  REPORT_TABLE,
+  REPORT_JSON,
+} ReportFormat;
+
+// When a phase started
+typedef struct Stopwatch {
+  double wall; // Seconds on a monotonic clock
+  double cpu;  // Seconds of CPU time
+  bool thread; // Whether cpu is for the calling thread, or the whole process
+} Stopwatch;
+
+typedef struct PhaseTime {
+  char *phase;
+  char *file; // NULL when the phase covers every file
+  double wall;
+  double cpu;
+  long long peakRss; // Bytes, the process high water mark when the phase ended
+} PhaseTime;
+
+typedef struct TimeReport {
+  ReportFormat format;
+
+  // The first fileCount entries are kept for per file phases, so that worker
+  // threads can each fill in their own without locking, the rest are whole
+  // program phases in the order they finished
+  PhaseTime *phases;
+  int fileCount;
+  int len;
+  int cap;
+} TimeReport;
+
+// Seconds on a monotonic clock, only useful for differences
+double wallSeconds(void);
+
+// Prints str as a quoted JSON string, file names can have backslashes in them
+// on Windows
+void printJsonString(FILE *f, char *str);
+
+// Nothing is recorded if the format is REPORT_NONE
+errno_t timeReportInit(TimeReport *r, ReportFormat format, int fileCount);
+void timeReportDestroy(TimeReport *r);
+
+// Starts timing a phase, thread is whether only the calling thread's CPU time
+// should count
+Stopwatch startStopwatch(TimeReport *r, bool thread);
+
+// Records a whole program phase, only call from the main thread
+void endPhase(TimeReport *r, Stopwatch start, char *phase);
+
+// Records a phase for one file, safe to call from any thread as long as each
+// file is only recorded once
+void endFilePhase(TimeReport *r, Stopwatch start, char *phase, int fileIndex,
+                  char *fileName);
+
+// Prints every recorded phase to stderr, in the report's format
+void printTimeReport(TimeReport *r);
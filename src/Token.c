@@ -1,5 +1,6 @@
 #include "Token.h"
 #include "Panic.h"
+#include "Stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -147,18 +148,18 @@ char *tokenCodeString(TokenCode tc) {
 }
 
 // Returns a string describing the token. The resulting string must be freed.
-char *tokenString(Token t) {
+char *tokenString(Token t, char *source) {
   // Get text of token code
   char *kind = tokenCodeString(t.kind);
 
   // The final string
   char *out;
 
-  if (t.data) {
-    out = malloc((strlen(kind) + strlen(t.data) + 4) * sizeof(char));
+  if (t.len) {
+    out = malloc((strlen(kind) + t.len + 4) * sizeof(char));
 
     // Format
-    sprintf(out, "(%s %s)", t.data, kind);
+    sprintf(out, "(%.*s %s)", t.len, source + t.start, kind);
   } else {
     out = malloc((strlen(kind) + 4 + 4) * sizeof(char));
 
@@ -173,54 +174,3 @@ char *tokenString(Token t) {
 
   return out;
 }
-
-errno_t TokenListInit(TokenList *l, int initialSize) {
-  if (initialSize < 0) {
-    return 1;
-  }
-  l->len = 0;
-  l->cap = initialSize;
-  l->p = (Token *)calloc(initialSize, sizeof(Token));
-  if (l->p == ((void *)0)) {
-    return 1;
-  }
-  return 0;
-}
-void TokenListDestroy(TokenList *l) { free(l->p); }
-errno_t TokenListAppend(TokenList *l, Token item) {
-  if (l->len == l->cap) {
-    l->cap *= 2;
-    Token *newP = (Token *)calloc(l->cap, sizeof(Token));
-    if (newP == ((void *)0)) {
-      return 1;
-    }
-    for (int i = 0; i < l->len; ++i) {
-      newP[i] = l->p[i];
-    }
-    free(l->p);
-    l->p = newP;
-  }
-  l->p[l->len] = item;
-  ++l->len;
-  return 0;
-}
-TokenList TokenListCopy(TokenList *src) {
-  TokenList dest;
-  dest.len = src->len;
-  dest.cap = src->len;
-  dest.p = (Token *)calloc(dest.cap, sizeof(Token));
-  for (int i = 0; i < src->len; ++i) {
-    dest.p[i] = src->p[i];
-  }
-  return dest;
-}
-errno_t TokenListRemoveAt(TokenList *l, int index) {
-  if (index < 0 || index >= l->len) {
-    return 1;
-  }
-  --l->len;
-  for (int i = index; i < l->len; ++i) {
-    l->p[i] = l->p[i + 1];
-  }
-  return 0;
-}
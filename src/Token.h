@@ -1,7 +1,5 @@
 #pragma once
 
-#include "list.h"
-
 typedef enum TokenCode {
   T_ILLEGAL,
 
@@ -78,20 +76,23 @@ typedef enum TokenCode {
   T_STRING,
 } TokenCode;
 
-#define ZERO_TOKEN (Token){NULL, T_ILLEGAL, 0}
+#define ZERO_TOKEN (Token){0, 0, T_ILLEGAL, 0}
 #define NEW_TOKEN(tokenType)                                                   \
-  (Token) { NULL, (tokenType), l->line }
+  (Token) { 0, 0, (tokenType), l->line }
 
 typedef struct Token {
-  char *data; // If the token has a constant data, it's NULL, and can always
-              // be decided
+  // Where the text of the token is in the source it was lexed from, the text
+  // isn't copied or interned until it's needed. If the token has constant text,
+  // len is 0, and it can always be decided
+  int start;
+  int len;
   TokenCode kind;
-  int line; // The line this token came from
+  int line;          // The line this token came from
+  unsigned int hash; // Identifiers only, the string manager hash of the text
 } Token;
 
 char *tokenCodeString(TokenCode tc);
 
-// Returns a string describing the token. The resulting string must be freed.
-char *tokenString(Token t);
-
-NEW_LIST_TYPE_HEADER(Token, Token)
+// Returns a string describing the token, the source is the one it was lexed
+// from. The resulting string must be freed.
+char *tokenString(Token t, char *source);
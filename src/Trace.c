@@ -0,0 +1,85 @@
+#include "Trace.h"
+
+#ifdef NAV_TRACE
+
+#include "TimeReport.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <threads.h>
+
+FILE *traceFile = NULL;
+bool traceFirst;
+double traceStart;
+
+// Events come from every front end thread
+mtx_t traceLock;
+
+// Chrome wants a number for each thread, so they're handed out as threads
+// write their first event
+atomic_int traceThreads = 0;
+thread_local int traceThread = -1;
+
+errno_t traceInit(char *fileName) {
+  if (fopen_s(&traceFile, fileName, "w")) {
+    return 1;
+  }
+
+  if (mtx_init(&traceLock, mtx_plain) != thrd_success) {
+    fclose(traceFile);
+    traceFile = NULL;
+    return 1;
+  }
+
+  traceFirst = true;
+  traceStart = wallSeconds();
+  fprintf(traceFile, "[");
+
+  return 0;
+}
+
+void traceDestroy(void) {
+  if (traceFile == NULL) {
+    return;
+  }
+
+  fprintf(traceFile, "\n]\n");
+  fclose(traceFile);
+  traceFile = NULL;
+  mtx_destroy(&traceLock);
+}
+
+void traceEvent(char phase, char *category, char *name) {
+  if (traceFile == NULL) {
+    return;
+  }
+
+  // Take the time before waiting on the lock
+  double ts = (wallSeconds() - traceStart) * 1e6;
+
+  if (traceThread < 0) {
+    traceThread = atomic_fetch_add(&traceThreads, 1);
+  }
+
+  mtx_lock(&traceLock);
+
+  fprintf(traceFile, "%s\n{\"ph\": \"%c\", \"cat\": ", traceFirst ? "" : ",",
+          phase);
+  printJsonString(traceFile, category);
+  fprintf(traceFile, ", \"name\": ");
+  printJsonString(traceFile, name);
+  fprintf(traceFile, ", \"ts\": %.3f, \"pid\": 1, \"tid\": %i}", ts,
+          traceThread);
+  traceFirst = false;
+
+  mtx_unlock(&traceLock);
+}
+
+void traceBegin(char *category, char *name) {
+  traceEvent('B', category, name);
+}
+
+void traceEnd(char *category, char *name) { traceEvent('E', category, name); }
+
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <corecrt.h>
+
+// Tracing and debug logging are only built in when NAV_TRACE is defined,
+// otherwise every macro here compiles to nothing, so they can go in hot paths.
+//
+// Traces are Chrome trace event JSON, which can be opened in Perfetto or
+// chrome://tracing. Each span is named, and grouped by the category it's in
+
+#ifdef NAV_TRACE
+
+#include <stdio.h>
+
+// Starts writing events to the file, events before this are dropped
+errno_t traceInit(char *fileName);
+
+// Finishes the trace, any spans still open are left open
+void traceDestroy(void);
+
+void traceBegin(char *category, char *name);
+void traceEnd(char *category, char *name);
+
+#define TRACE_BEGIN(category, name) traceBegin((category), (name))
+#define TRACE_END(category, name) traceEnd((category), (name))
+#define LOG(...) printf(__VA_ARGS__)
+
+#else
+
+#define TRACE_BEGIN(category, name)
+#define TRACE_END(category, name)
+#define LOG(...)
+
+#endif
@@ -3,6 +3,7 @@
 #include "TypeModifier.h"
 #include "list.h"
 #include <stdlib.h>
+#include <string.h>
 
 NEW_LIST_TYPE_HEADER(char, Char)
 
@@ -23,10 +24,7 @@ char *typeString(Type *t) {
       break;
 
     case TM_ARRAY:
-      if (CharListAppend(&out, '[')) {
-        panic("Couldn't append to charlist");
-      }
-      if (CharListAppend(&out, ']')) {
+      if (CharListAppendN(&out, "[]", 2)) {
         panic("Couldn't append to charlist");
       }
       break;
@@ -36,29 +34,11 @@ char *typeString(Type *t) {
 
       // Null case
       if (name == NULL) {
-        if (CharListAppend(&out, 'N')) {
-          panic("Couldn't append to charlist");
-        }
-        if (CharListAppend(&out, 'U')) {
-          panic("Couldn't append to charlist");
-        }
-        if (CharListAppend(&out, 'L')) {
-          panic("Couldn't append to charlist");
-        }
-        if (CharListAppend(&out, 'L')) {
-          panic("Couldn't append to charlist");
-        }
-
-        break;
+        name = "NULL";
       }
 
-      int i = 0;
-
-      while (name[i]) {
-        if (CharListAppend(&out, name[i])) {
-          panic("Couldn't append to charlist");
-        }
-        ++i;
+      if (CharListAppendN(&out, name, strlen(name))) {
+        panic("Couldn't append to charlist");
       }
 
       break;
@@ -68,16 +48,17 @@ char *typeString(Type *t) {
     cur = cur->parent;
   }
 
+  if (CharListAppend(&out, 0)) {
+    panic("Couldn't append to charlist");
+  }
+
   return out.p;
 }
 
 void typeStackPush(TypeStack *s, TypeKind kind, char *name, TypeModifier mod,
                    Type *parent) {
 
-  Type *n = calloc(1, sizeof(Type));
-  if (n == NULL) {
-    panic("Couldn't allocated node for stack");
-  }
+  Type *n = arenaAlloc(s->arena, sizeof(Type));
 
   n->kind = kind;
   n->name = name;
@@ -95,8 +76,6 @@ void typeStackPush(TypeStack *s, TypeKind kind, char *name, TypeModifier mod,
   s->tail = n;
 }
 
-// The reason we return the thing and not the pointer to the thing is because we
-// free the pointer, so we're returning a copy
 Type typeStackPop(TypeStack *s) {
   if (s->len == 0) {
     return ZERO_TYPE;
@@ -104,21 +83,12 @@ Type typeStackPop(TypeStack *s) {
 
   --s->len;
 
-  if (s->len == 0) {
-    Type tail = *(s->tail);
-    free(s->tail);
-    s->tail = NULL;
-    return tail;
-  }
-
-  Type tail = *(s->tail);
-  free(s->tail);
-  s->tail = s->tail->next;
-  return tail;
+  Type *tail = s->tail;
+  s->tail = s->len == 0 ? NULL : tail->next;
+  return *tail;
 }
 
 void typeStackClear(TypeStack *s) {
-  while (s->len > 0) {
-    typeStackPop(s);
-  }
+  s->tail = NULL;
+  s->len = 0;
 }
@@ -2,6 +2,7 @@
 
 typedef struct Type Type;
 
+#include "Arena.h"
 #include "Ident.h"
 
 #define ZERO_TYPE                                                              \
@@ -32,15 +33,16 @@ typedef struct Type {
 typedef struct TypeStack {
   Type *tail;
   int len;
+  Arena *arena; // Where pushes come from, popping doesn't give anything back
 } TypeStack;
 
 void typeStackPush(TypeStack *s, TypeKind kind, char *name, TypeModifier mod,
                    Type *parent);
 
-// The reason we return the thing and not the pointer to the thing is because we
-// free the pointer, so we're returning a copy
+// Returns a copy of what was on top
 Type typeStackPop(TypeStack *s);
 
+// Empties the stack in one step, the memory goes with the arena
 void typeStackClear(TypeStack *s);
 
 char *typeString(Type *t);
@@ -0,0 +1,134 @@
+#include "Watch.h"
+
+#ifndef __linux__
+
+#include <stdio.h>
+
+int runWatch(int argc, char *argv[]) {
+  printf("--watch needs inotify, which is only on Linux\n");
+  return 1;
+}
+
+#else
+
+#include "Compile.h"
+#include "Incremental.h"
+#include "Stats.h"
+
+#include <libgen.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// How long to wait after a change for the rest of a save to land, editors
+// often write a file in several steps
+#define SETTLE_MS 50
+
+// Editors often save by writing a new file and renaming it over the old one,
+// which a watch on the file itself would lose track of, so each file's
+// directory is watched and events are matched by name
+typedef struct WatchedFile {
+  int wd;
+  char *base;
+} WatchedFile;
+
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE)
+
+errno_t watchFiles(int fd, char **fileNames, int fileCount,
+                   WatchedFile watched[]) {
+  for (int i = 0; i < fileCount; ++i) {
+    // dirname and basename can change what they're given
+    char dirCopy[PATH_MAX], baseCopy[PATH_MAX];
+    snprintf(dirCopy, sizeof(dirCopy), "%s", fileNames[i]);
+    snprintf(baseCopy, sizeof(baseCopy), "%s", fileNames[i]);
+
+    watched[i].wd = inotify_add_watch(fd, dirname(dirCopy), WATCH_EVENTS);
+    watched[i].base = strdup(basename(baseCopy));
+    if (watched[i].wd < 0) {
+      printf("Couldn't watch %s\n", fileNames[i]);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+// Reads what's waiting, returns true if any of it was about a watched file
+bool readChanges(int fd, WatchedFile watched[], int fileCount) {
+  char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  ssize_t len = read(fd, buf, sizeof(buf));
+  bool changed = false;
+
+  for (char *at = buf; len > 0 && at < buf + len;) {
+    struct inotify_event *e = (struct inotify_event *)at;
+    at += sizeof(struct inotify_event) + e->len;
+
+    for (int i = 0; i < fileCount && e->len > 0; ++i) {
+      changed = changed ||
+                (watched[i].wd == e->wd && !strcmp(watched[i].base, e->name));
+    }
+  }
+
+  return changed;
+}
+
+// Blocks until a watched file changes and things have gone quiet
+void waitForChange(int fd, WatchedFile watched[], int fileCount) {
+  while (!readChanges(fd, watched, fileCount)) {
+  }
+
+  struct pollfd p = {fd, POLLIN, 0};
+  while (poll(&p, 1, SETTLE_MS) > 0) {
+    readChanges(fd, watched, fileCount);
+  }
+}
+
+int runWatch(int argc, char *argv[]) {
+  char *fileNames[argc];
+  Options o = {fileNames};
+  if (readOptions(&o, argc, argv)) {
+    return 1;
+  }
+
+  // Both are written once the process ends, which watching never does
+  if (o.traceName != NULL || statsEnabled) {
+    printf("--trace and --stats can't be used with --watch\n");
+    return 1;
+  }
+
+  if (validateFiles(&o)) {
+    return 1;
+  }
+
+  Incremental inc;
+  if (incrementalInit(&inc)) {
+    printf("Couldn't load string manager\n");
+    return 1;
+  }
+
+  int fd = inotify_init1(IN_CLOEXEC);
+  WatchedFile watched[o.fileCount > 0 ? o.fileCount : 1];
+  if (fd < 0 || watchFiles(fd, fileNames, o.fileCount, watched)) {
+    printf("Couldn't start watching the files\n");
+    return 1;
+  }
+
+  // Only files whose contents changed are parsed again, the back end always
+  // runs since any file can change what the others mean
+  while (true) {
+    int status = incrementalCompile(&inc, &o);
+    printf("\nCompile %s, watching for changes\n",
+           status ? "failed" : "finished");
+    fflush(stdout);
+
+    waitForChange(fd, watched, o.fileCount);
+    printf("\n");
+  }
+}
+
+#endif
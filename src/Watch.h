@@ -0,0 +1,7 @@
+#pragma once
+
+// Compiles the files, then compiles them again every time one of them is
+// saved, until killed. Takes the same arguments as a normal compile and
+// reuses the parse trees of files that didn't change. Only available on
+// Linux, where there's inotify
+int runWatch(int argc, char *argv[]);
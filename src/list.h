@@ -1,12 +1,42 @@
 #pragma once
 
+#include "Stats.h"
+
 #include <corecrt.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define ZERO_LIST (NodeList){NULL, 0, 0}
 
-// TODO:
-// pop, insert, clear, slice, sliceEnd, join, splice?
+// A growable array of T named TYPE_NAME##List. NEW_LIST_TYPE_HEADER declares
+// it, NEW_LIST_TYPE_IMPL defines its functions in one source file, and
+// NEW_LIST_TYPE does both for a list only used in one file.
+//
+// Lists grow by doubling with realloc, so the items can move whenever one is
+// added. Ranges are given as a start index and a count.
+//
+// An empty list made with an initial size of 0 doesn't allocate, its p points
+// at a shared zeroed item instead, so reading p[0] still gives a zero item.
+// Most nodes have no children, and the rest usually have only a few, so a
+// list's first allocation has room for LIST_FIRST_CAP.
+//
+// NEW_LIST_TYPE_IMPL_FROM takes where the items live as two statement macros,
+// GROW(newP, p, oldBytes, newBytes, SUBSYSTEM) which sets newP to p moved to
+// newBytes, or NULL, and RELEASE(p, bytes, SUBSYSTEM). p is NULL the first
+// time. The LIST_HEAP ones are what NEW_LIST_TYPE_IMPL uses
+
+#define LIST_FIRST_CAP 4
+
+#define LIST_HEAP_GROW(newP, p, oldBytes, newBytes, SUBSYSTEM)                 \
+  newP = realloc((p), (newBytes));                                             \
+  if (newP != NULL) {                                                          \
+    STAT_FREE(SUBSYSTEM, oldBytes)                                             \
+    STAT_ALLOC(SUBSYSTEM, newBytes)                                            \
+  }
+
+#define LIST_HEAP_RELEASE(p, bytes, SUBSYSTEM)                                 \
+  STAT_FREE(SUBSYSTEM, bytes)                                                  \
+  free(p);
 
 #define NEW_LIST_TYPE_HEADER(T, TYPE_NAME)                                     \
   typedef struct TYPE_NAME##List {                                             \
@@ -16,77 +46,147 @@
   } TYPE_NAME##List;                                                           \
   errno_t TYPE_NAME##ListInit(TYPE_NAME##List *l, int initialSize);            \
   void TYPE_NAME##ListDestroy(TYPE_NAME##List *l);                             \
+  /* Makes room for at least cap items without growing again */                \
+  errno_t TYPE_NAME##ListReserve(TYPE_NAME##List *l, int cap);                 \
   errno_t TYPE_NAME##ListAppend(TYPE_NAME##List *l, T item);                   \
+  errno_t TYPE_NAME##ListAppendN(TYPE_NAME##List *l, const T *items, int n);   \
   TYPE_NAME##List TYPE_NAME##ListCopy(TYPE_NAME##List *src);                   \
+  /* Copies n items from start into a new list */                              \
+  errno_t TYPE_NAME##ListSlice(TYPE_NAME##List *dest, TYPE_NAME##List *src,    \
+                               int start, int n);                              \
   errno_t TYPE_NAME##ListRemoveAt(TYPE_NAME##List *l, int index);              \
-  errno_t TYPE_NAME##ListInsertAt(TYPE_NAME##List *l, T item, int index);
+  errno_t TYPE_NAME##ListRemoveN(TYPE_NAME##List *l, int index, int n);        \
+  errno_t TYPE_NAME##ListInsertAt(TYPE_NAME##List *l, T item, int index);      \
+  /* items can't point into l, it may move */                                  \
+  errno_t TYPE_NAME##ListInsertN(TYPE_NAME##List *l, int index,                \
+                                 const T *items, int n);                       \
+  /* Removes the last item, copying it to item unless that's NULL */           \
+  errno_t TYPE_NAME##ListPop(TYPE_NAME##List *l, T *item);                     \
+  /* Empties the list, keeping its memory */                                   \
+  void TYPE_NAME##ListClear(TYPE_NAME##List *l);
 
-#define NEW_LIST_TYPE(T, TYPE_NAME)                                            \
-  typedef struct TYPE_NAME##List {                                             \
-    T *p;                                                                      \
-    int len;                                                                   \
-    int cap;                                                                   \
-  } TYPE_NAME##List;                                                           \
+#define NEW_LIST_TYPE_IMPL(T, TYPE_NAME, SUBSYSTEM)                            \
+  NEW_LIST_TYPE_IMPL_FROM(T, TYPE_NAME, SUBSYSTEM, LIST_HEAP_GROW,             \
+                          LIST_HEAP_RELEASE)
+
+#define NEW_LIST_TYPE_IMPL_FROM(T, TYPE_NAME, SUBSYSTEM, GROW, RELEASE)        \
+  T TYPE_NAME##ListNoItems;                                                    \
   errno_t TYPE_NAME##ListInit(TYPE_NAME##List *l, int initialSize) {           \
     if (initialSize < 0) {                                                     \
       return 1;                                                                \
     }                                                                          \
     l->len = 0;                                                                \
     l->cap = initialSize;                                                      \
-    l->p = (T *)calloc(initialSize, sizeof(T));                                \
+    if (initialSize == 0) {                                                    \
+      l->p = &TYPE_NAME##ListNoItems;                                          \
+      return 0;                                                                \
+    }                                                                          \
+    GROW(l->p, NULL, 0, initialSize * sizeof(T), SUBSYSTEM)                    \
     if (l->p == NULL) {                                                        \
       return 1;                                                                \
     }                                                                          \
+    memset(l->p, 0, initialSize * sizeof(T));                                  \
     return 0;                                                                  \
   }                                                                            \
-  void TYPE_NAME##ListDestroy(TYPE_NAME##List *l) { free(l->p); }              \
+  void TYPE_NAME##ListDestroy(TYPE_NAME##List *l) {                            \
+    if (l->cap > 0) {                                                          \
+      RELEASE(l->p, l->cap * sizeof(T), SUBSYSTEM)                             \
+    }                                                                          \
+  }                                                                            \
+  errno_t TYPE_NAME##ListReserve(TYPE_NAME##List *l, int cap) {                \
+    if (cap <= l->cap) {                                                       \
+      return 0;                                                                \
+    }                                                                          \
+    T *newP;                                                                   \
+    GROW(newP, l->cap > 0 ? l->p : NULL, l->cap * sizeof(T), cap * sizeof(T),  \
+         SUBSYSTEM)                                                            \
+    if (newP == NULL) {                                                        \
+      return 1;                                                                \
+    }                                                                          \
+    l->p = newP;                                                               \
+    l->cap = cap;                                                              \
+    return 0;                                                                  \
+  }                                                                            \
+  /* Doubles until there's room for n more */                                  \
+  errno_t TYPE_NAME##ListGrow(TYPE_NAME##List *l, int n) {                     \
+    if (l->len + n <= l->cap) {                                                \
+      return 0;                                                                \
+    }                                                                          \
+    int cap = l->cap > 0 ? l->cap : LIST_FIRST_CAP;                            \
+    while (cap < l->len + n) {                                                 \
+      cap *= 2;                                                                \
+    }                                                                          \
+    return TYPE_NAME##ListReserve(l, cap);                                     \
+  }                                                                            \
   errno_t TYPE_NAME##ListAppend(TYPE_NAME##List *l, T item) {                  \
-    if (l->len == l->cap) {                                                    \
-      l->cap *= 2;                                                             \
-      T *newP = (T *)calloc(l->cap, sizeof(T));                                \
-      if (newP == NULL) {                                                      \
-        return 1;                                                              \
-      }                                                                        \
-      for (int i = 0; i < l->len; ++i) {                                       \
-        newP[i] = l->p[i];                                                     \
-      }                                                                        \
-      free(l->p);                                                              \
-      l->p = newP;                                                             \
+    if (l->len == l->cap && TYPE_NAME##ListGrow(l, 1)) {                       \
+      return 1;                                                                \
     }                                                                          \
     l->p[l->len] = item;                                                       \
     ++l->len;                                                                  \
     return 0;                                                                  \
   }                                                                            \
+  errno_t TYPE_NAME##ListAppendN(TYPE_NAME##List *l, const T *items, int n) {  \
+    return TYPE_NAME##ListInsertN(l, l->len, items, n);                        \
+  }                                                                            \
   TYPE_NAME##List TYPE_NAME##ListCopy(TYPE_NAME##List *src) {                  \
     TYPE_NAME##List dest;                                                      \
-    dest.len = src->len;                                                       \
-    dest.cap = src->len;                                                       \
-    dest.p = (T *)calloc(dest.cap, sizeof(T));                                 \
-    for (int i = 0; i < src->len; ++i) {                                       \
-      dest.p[i] = src->p[i];                                                   \
-    }                                                                          \
+    TYPE_NAME##ListInit(&dest, 0);                                             \
+    TYPE_NAME##ListAppendN(&dest, src->p, src->len);                           \
     return dest;                                                               \
   }                                                                            \
-  errno_t TYPE_NAME##ListRemoveAt(TYPE_NAME##List *l, int index) {             \
-    if (index < 0 || index >= l->len) {                                        \
+  errno_t TYPE_NAME##ListSlice(TYPE_NAME##List *dest, TYPE_NAME##List *src,    \
+                               int start, int n) {                             \
+    if (start < 0 || n < 0 || start + n > src->len) {                          \
       return 1;                                                                \
     }                                                                          \
-    --l->len;                                                                  \
-    for (int i = index; i < l->len; ++i) {                                     \
-      l->p[i] = l->p[i + 1];                                                   \
+    if (TYPE_NAME##ListInit(dest, 0)) {                                        \
+      return 1;                                                                \
+    }                                                                          \
+    return TYPE_NAME##ListAppendN(dest, src->p + start, n);                    \
+  }                                                                            \
+  errno_t TYPE_NAME##ListRemoveAt(TYPE_NAME##List *l, int index) {             \
+    return TYPE_NAME##ListRemoveN(l, index, 1);                                \
+  }                                                                            \
+  errno_t TYPE_NAME##ListRemoveN(TYPE_NAME##List *l, int index, int n) {       \
+    if (index < 0 || n < 0 || index + n > l->len) {                            \
+      return 1;                                                                \
     }                                                                          \
+    memmove(l->p + index, l->p + index + n,                                    \
+            (l->len - index - n) * sizeof(T));                                 \
+    l->len -= n;                                                               \
     return 0;                                                                  \
   }                                                                            \
   errno_t TYPE_NAME##ListInsertAt(TYPE_NAME##List *l, T item, int index) {     \
-    if (index < 0 || index > l->len) {                                         \
+    return TYPE_NAME##ListInsertN(l, index, &item, 1);                         \
+  }                                                                            \
+  errno_t TYPE_NAME##ListInsertN(TYPE_NAME##List *l, int index,                \
+                                 const T *items, int n) {                      \
+    if (index < 0 || index > l->len || n < 0) {                                \
       return 1;                                                                \
     }                                                                          \
-    if (TYPE_NAME##ListAppend(l, l->p[l->len - 1])) {                          \
+    if (TYPE_NAME##ListGrow(l, n)) {                                           \
       return 1;                                                                \
     }                                                                          \
-    for (int i = l->len - 2; i > index; --i) {                                 \
-      l->p[i] = l->p[i - 1];                                                   \
+    memmove(l->p + index + n, l->p + index, (l->len - index) * sizeof(T));     \
+    if (n > 0) {                                                               \
+      memcpy(l->p + index, items, n * sizeof(T));                              \
     }                                                                          \
-    l->p[index] = item;                                                        \
+    l->len += n;                                                               \
     return 0;                                                                  \
-  }
+  }                                                                            \
+  errno_t TYPE_NAME##ListPop(TYPE_NAME##List *l, T *item) {                    \
+    if (l->len == 0) {                                                         \
+      return 1;                                                                \
+    }                                                                          \
+    --l->len;                                                                  \
+    if (item != NULL) {                                                        \
+      *item = l->p[l->len];                                                    \
+    }                                                                          \
+    return 0;                                                                  \
+  }                                                                            \
+  void TYPE_NAME##ListClear(TYPE_NAME##List *l) { l->len = 0; }
+
+#define NEW_LIST_TYPE(T, TYPE_NAME, SUBSYSTEM)                                 \
+  NEW_LIST_TYPE_HEADER(T, TYPE_NAME)                                           \
+  NEW_LIST_TYPE_IMPL(T, TYPE_NAME, SUBSYSTEM)
@@ -1,177 +1,111 @@
-#include "Analyser.h"
-#include "Emitter.h"
-#include "Hoister.h"
-#include "Lexer.h"
-#include "Optimiser.h"
+#include "Compile.h"
 #include "Parser.h"
+#include "Server.h"
+#include "Stats.h"
 #include "StringManager.h"
+#include "TimeReport.h"
+#include "Trace.h"
+#include "Watch.h"
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 
-bool validFileName(char fileName[]) {
-  int i = 0;
-  int dotIndex = -1;
-  while (fileName[i]) {
-    if (fileName[i] == '.') {
-      dotIndex = i;
+int main(int argc, char *argv[]) {
+  // The server and its clients take over before the usual options are read
+  if (argc > 1 && !strcmp(argv[1], "--serve")) {
+    if (argc != 3) {
+      printf("--serve expects a socket to listen on, and nothing else\n");
+      return 1;
     }
-    ++i;
-  }
-
-  // No file extension
-  if (dotIndex == -1) {
-    return false;
+    return runServer(argv[2]);
   }
 
-  // Correct file extension length
-  if (i - dotIndex != 4) {
-    return false;
-  }
-
-  // Check extension
-  if (fileName[dotIndex + 1] != 'n') {
-    return false;
+  if (argc > 1 && !strcmp(argv[1], "--connect")) {
+    if (argc < 3) {
+      printf("--connect expects the socket the server is listening on\n");
+      return 1;
+    }
+    return runClient(argv[2], argc - 3, argv + 3);
   }
 
-  if (fileName[dotIndex + 2] != 'a') {
-    return false;
+  // argv[1] takes the place of the program name, which the options skip
+  if (argc > 1 && !strcmp(argv[1], "--watch")) {
+    return runWatch(argc - 1, argv + 1);
   }
 
-  if (fileName[dotIndex + 3] != 'v') {
-    return false;
+  // Split the options from the files
+  char *fileNames[argc];
+  Options o = {fileNames};
+  if (readOptions(&o, argc, argv)) {
+    return 1;
   }
 
-  // It's good
-  return true;
-}
-
-int main(int argc, char *argv[]) {
   // Check every file name
-  printf("Validating files\n");
-  for (int i = 1; i < argc; ++i) {
-    if (!validFileName(argv[i])) {
-      printf("Filename %s had incorrect file extension.\n", argv[i]);
-      return 1;
-    }
+  if (validateFiles(&o)) {
+    return 1;
   }
 
   // Load in string manager
   printf("Loading string manager\n");
   StringManager sm;
-  initStringManager(&sm);
-
-  // Load all file pointers
-  printf("Opening files\n");
-  FILE *files[argc - 1];
-  errno_t err;
-  for (int i = 1; i < argc; ++i) {
-    // Open the file
-    err = fopen_s(&files[i - 1], argv[i], "r");
-    if (err) {
-      _fcloseall();
-      printf("Couldn't open file %s\n", argv[i]);
-      exit(1);
-    }
+  if (initStringManager(&sm)) {
+    printf("Couldn't load string manager\n");
+    return 1;
   }
-  printf("End validating files\n\n");
 
-  // Lex every file
-  printf("Lexing\n");
-  Lexer lexers[argc - 1];
-  for (int i = 1; i < argc; ++i) {
-    lexerInit(&lexers[i - 1], argv[i], files[i - 1], &sm);
-    lex(&lexers[i - 1]);
+#ifdef NAV_TRACE
+  if (o.traceName != NULL && traceInit(o.traceName)) {
+    printf("Couldn't open trace file %s\n", o.traceName);
+    return 1;
   }
+#else
+  if (o.traceName != NULL) {
+    printf("--trace needs the compiler to be built with NAV_TRACE defined\n");
+    return 1;
+  }
+#endif
 
-  // Print all lexed soruces
-  // for (int i = 0; i < argc - 1; ++i) {
-  //   for (int j = 0; j < lexers[i].out.len; ++j) {
-  //     printf("%s, ", tokenString(&lexers[i].out.p[j]));
-  //   }
-  //   printf("\n");
-  // }
-
-  // Close all the files before moving on
-  printf("Closing files\n");
-  _fcloseall();
-  printf("End lexing\n\n");
-
-  // Parse every file
-  printf("Parsing\n");
-
-  Parser parsers[argc - 1];
-
-  for (int i = 1; i < argc; ++i) {
-    printf("Parsing %s\n", argv[i]);
-    parserInit(&parsers[i - 1], argv[i], lexers[i - 1].out, &sm);
-    parse(&parsers[i - 1]);
-
-    // char *out = nodeString(&parsers[i - 1].out);
-    // printf("%s\n", out);
-    // free(out);
+  TimeReport report;
+  if (timeReportInit(&report, o.reportFormat, o.fileCount)) {
+    printf("Couldn't start time report\n");
+    return 1;
   }
 
-  // Destroy the tokens
-  printf("Destroying Lexer garbage\n");
-  for (int i = 1; i < argc; ++i) {
-    TokenListDestroy(&lexers[i - 1].out);
+  printf("End validating files\n\n");
+
+  // Lex and parse every file
+  printf("Lexing and parsing\n");
+  Stopwatch sw = startStopwatch(&report, false);
+  TRACE_BEGIN("phase", "Lexing and parsing");
+  Parser parsers[o.fileCount > 0 ? o.fileCount : 1];
+  frontEnd(fileNames, o.fileCount, parsers, o.jobs, &sm, &report, false,
+           o.cacheDir);
+  TRACE_END("phase", "Lexing and parsing");
+  endPhase(&report, sw, "Lexing and parsing");
+  printf("End lexing and parsing\n\n");
+
+  backEnd(parsers, o.fileCount, &o, &sm, &report);
+
+  printf("Destroying parse trees\n");
+  for (int i = 0; i < o.fileCount; ++i) {
+    arenaDestroy(&parsers[i].arena);
   }
-  printf("End parsing\n\n");
-
-  // Hoist from each file into one place
-  printf("Hoisting\n");
-  Hoister h;
-  hoist(&h, parsers, argc - 1);
-  printf("End hoisting\n\n");
-
-  char *out;
-  //
-  // out = nodeString(&h.enums);
-  // printf("Enums\n%s\n", out);
-  // free(out);
-  //
-  // out = nodeString(&h.structs);
-  // printf("Structs\n%s\n", out);
-  // free(out);
-  //
-  // out = nodeString(&h.funcs);
-  // printf("Funcs\n%s\n", out);
-  // free(out);
-
-  // Semantic Analysis
-  printf("Analysing\n");
-  Analyser a;
-  analyserInit(&a, h.enums, h.structs, h.funcs, &sm);
-  analyse(&a);
-  printf("End anlysis\n\n");
-
-  // Optimise
-  printf("Optimising\n");
-  Optimiser o;
-  optimiserInit(&o, a.inFuns, &sm);
-  printf("Optimiser init\n");
-  optimise(&o);
-  printf("End optimisation\n\n");
-
-  // Emit to C
-  printf("Emitting\n");
-  Emitter e;
-  emitterInit(&e, a.inEnums, a.inStructs, a.inFuns, &sm);
-  printf("Emitter initialised\n");
-  CharList finalOutput = emit(&e);
-  printf("End emitting\n\n");
-
-  printf("Saving to file\n");
-  FILE *fptr;
-  fopen_s(&fptr, "../output/main.c", "w");
-  fwrite(finalOutput.p, sizeof(char), finalOutput.len, fptr);
-  fclose(fptr);
-  printf("Saved\n\n");
 
   printf("Destroying string manager\n");
   destroyStringManager(&sm);
 
   printf("Finished\n");
 
+#ifdef NAV_TRACE
+  traceDestroy();
+#endif
+
+  printTimeReport(&report);
+  timeReportDestroy(&report);
+
+  if (statsEnabled) {
+    printStats();
+  }
+
   return 0;
 }